@@ -64,6 +64,139 @@ static void BM_dot(benchmark::State &state) {
 
 BENCHMARK(BM_dot);
 
+static void BM_equal(benchmark::State &state) {
+    array a({1000, 1000}, 1.0);
+    array b({1000, 1000}, 1.0);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(a == b);
+    }
+}
+
+BENCHMARK(BM_equal);
+
+static void BM_allclose(benchmark::State &state) {
+    array a({1000, 1000}, 1.0);
+    array b({1000, 1000}, 1.0);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(nd::allclose(a, b));
+    }
+}
+
+BENCHMARK(BM_allclose);
+
+static void BM_sort(benchmark::State &state) {
+    array a({1000, 1000}, 0.0);
+    a.random(-1, 1);
+
+    while (state.KeepRunning()) {
+        auto b = a;
+        b.sort();
+    }
+}
+
+BENCHMARK(BM_sort);
+
+static void BM_topk(benchmark::State &state) {
+    array a(std::deque<unsigned long>({1000000}), 0.0);
+    a.random(-1, 1);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(a.topk(100));
+    }
+}
+
+BENCHMARK(BM_topk);
+
+static void BM_dot_large(benchmark::State &state) {
+    array a({256, 256}, 0.0);
+    array b({256, 256}, 0.0);
+
+    while (state.KeepRunning()) {
+        a.dot(b);
+    }
+}
+
+BENCHMARK(BM_dot_large);
+
+static void BM_dot_out(benchmark::State &state) {
+    array a({64, 64}, 1.0);
+    array b({64, 64}, 2.0);
+    array out({64, 64}, 0.0);
+    nd::workspace ws;
+
+    while (state.KeepRunning()) {
+        a.dot(b, out, ws);
+    }
+}
+
+BENCHMARK(BM_dot_out);
+
+static void BM_dot_small(benchmark::State &state) {
+    array a({64, 64}, 1.0);
+    array b({64, 64}, 2.0);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(a.dot(b));
+    }
+}
+
+BENCHMARK(BM_dot_small);
+
+static void BM_convolve(benchmark::State &state) {
+    array image({512, 512}, 0.0);
+    array kernel({3, 3}, 1.0);
+
+    while (state.KeepRunning()) {
+        nd::convolve(image, kernel, nd::conv_mode::same);
+    }
+}
+
+BENCHMARK(BM_convolve);
+
+static void BM_stack(benchmark::State &state) {
+    std::vector<array> samples(4096, array({16, 16}, 1.0));
+
+    while (state.KeepRunning()) {
+        nd::stack(samples);
+    }
+}
+
+BENCHMARK(BM_stack);
+
+static void BM_histogram(benchmark::State &state) {
+    array a(std::deque<unsigned long>({1 << 22}), 0.0);
+    a.random(-1, 1);
+
+    while (state.KeepRunning()) {
+        nd::histogram(a, 64, -1., 1.);
+    }
+
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+
+BENCHMARK(BM_histogram);
+
+static void BM_group_by(benchmark::State &state) {
+    nd::buffer_t<int> ids(1 << 22);
+    array values(std::deque<unsigned long>({1 << 22}), 1.0);
+
+    for (unsigned long i = 0; i < ids.size(); ++i) {
+        ids[i] = (int) ((i * 2654435761ul) % 1000);
+    }
+
+    nd::array<int> keys(std::move(ids), {1 << 22});
+
+    while (state.KeepRunning()) {
+        nd::group_by(keys, values, nd::reduce_op::mean);
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK(BM_group_by);
+
 /////////////////////////////
 //    old lib benchmark    //
 /////////////////////////////
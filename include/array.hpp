@@ -29,6 +29,26 @@ SOFTWARE.
 #include <deque>
 #include <random>
 #include <iomanip>
+#include <vector>
+#include <numeric>
+#include <functional>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <exception>
+#include <atomic>
+#include <complex>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace nd {
     enum class value_t : uint8_t {
@@ -37,6 +57,753 @@ namespace nd {
         array,
     };
 
+    ///////////////
+    // allocator //
+    ///////////////
+
+    // std::allocator that leaves elements default initialized when no value is
+    // given, so the pages of a fresh buffer are first touched by the kernel that
+    // fills it and not by the thread that allocated it
+    template<class T>
+    class allocator : public std::allocator<T> {
+    public:
+        template<class U>
+        struct rebind {
+            using other = allocator<U>;
+        };
+
+        allocator() = default;
+
+        template<class U>
+        allocator(const allocator<U> &) noexcept {}
+
+        template<class U>
+        void construct(U *ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
+            ::new(static_cast<void *>(ptr)) U;
+        }
+
+        template<class U, class... Args>
+        void construct(U *ptr, Args &&... args) {
+            ::new(static_cast<void *>(ptr)) U(std::forward<Args>(args)...);
+        }
+    };
+
+    // element storage of nd::array and the type returned by array::data(). it is
+    // not a std::vector<T>, copy through begin() and end() where one is needed.
+    template<class T>
+    using buffer_t = std::vector<T, allocator<T>>;
+
+    // where the pages of newly initialized arrays end up on a numa machine
+    enum class placement : uint8_t {
+        first_touch, // every executor worker touches the chunk it later processes
+        interleave,  // pages are touched round robin by the workers
+        local,       // the calling thread touches everything
+    };
+
+    inline std::atomic<placement> &__placement() {
+        static std::atomic<placement> policy(placement::first_touch);
+        return policy;
+    }
+
+    inline placement get_placement() { return __placement(); }
+
+    inline void set_placement(placement policy) { __placement() = policy; }
+
+    //////////////
+    // executor //
+    //////////////
+
+    class executor {
+    public:
+        explicit executor(unsigned long workers = std::thread::hardware_concurrency()) {
+            if (workers == 0) workers = 1;
+
+            for (unsigned long i = 0; i < workers; ++i) {
+                m_workers.emplace_back(new worker());
+                m_workers.back()->pool = this;
+            }
+
+            for (auto &w : m_workers) {
+                auto ptr = w.get();
+                w->thread = std::thread([this, ptr] { __run(*ptr); });
+            }
+        }
+
+        executor(const executor &) = delete;
+
+        executor &operator=(const executor &) = delete;
+
+        ~executor() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+
+            m_cv.notify_all();
+
+            for (auto &w : m_workers) {
+                w->thread.join();
+            }
+        }
+
+        // process wide pool used by the array kernels
+        static executor &instance() {
+            static executor ex;
+            return ex;
+        }
+
+        // true when called from one of the threads of this pool. a worker of another
+        // pool is an ordinary caller here.
+        bool in_worker() const {
+            auto w = __current();
+            return w != nullptr && w->pool == this;
+        }
+
+        unsigned long size() const { return m_workers.size(); }
+
+        // binds worker i to the i-th cpu the process may run on. with the static
+        // chunking of parallel_for, neighbouring chunks then stay on the same
+        // socket. returns false when the platform does not support it.
+        bool pin_workers() {
+#ifdef __linux__
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+                return false;
+
+            std::vector<int> cpus;
+
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+
+            if (cpus.empty())
+                return false;
+
+            for (unsigned long i = 0; i < m_workers.size(); ++i) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpus[i % cpus.size()], &set);
+
+                if (pthread_setaffinity_np(m_workers[i]->thread.native_handle(), sizeof(set), &set) != 0)
+                    return false;
+            }
+
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // queue a task on the given worker. tasks must not throw.
+        void submit(std::function<void()> task, unsigned long worker_id) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_workers.at(worker_id % m_workers.size())->tasks.push_back(std::move(task));
+            }
+
+            m_cv.notify_all();
+        }
+
+        // queue a task for whichever worker is free first. these never delay the
+        // chunks of parallel_for, a worker always takes its own chunks first.
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_shared.push_back(std::move(task));
+            }
+
+            m_cv.notify_one();
+        }
+
+        // splits [begin, end) in at most size() contiguous chunks of at least grain
+        // items. chunk i is queued on worker i, so repeated calls over the same range
+        // touch the same memory from the same thread. only when worker i is busy
+        // with something else may an idle worker steal the chunk. called from a
+        // worker of this pool, e.g. by a kernel inside an async task, the chunks are
+        // queued all the same and the worker runs queued chunks while it waits.
+        template<typename callback>
+        void parallel_for(unsigned long begin, unsigned long end, callback clb, unsigned long grain = 1) {
+            if (end <= begin)
+                return;
+
+            auto n = end - begin;
+            auto chunks = std::min(size(), (n + grain - 1) / std::max(grain, 1ul));
+
+            if (chunks <= 1) {
+                clb(begin, end);
+                return;
+            }
+
+            auto self = in_worker() ? __current() : nullptr;
+
+            job j;
+            j.run = &__invoke<callback>;
+            j.clb = &clb;
+            j.begin = begin;
+            j.n = n;
+            j.chunks = chunks;
+            j.pending = chunks;
+            j.helped = self != nullptr;
+
+            frame f(chunks);
+            auto nodes = f.nodes;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                for (unsigned long c = 0; c < chunks; ++c) {
+                    nodes[c].owner = &j;
+                    nodes[c].index = c;
+                    __push(*m_workers[c], &nodes[c]);
+                }
+            }
+
+            m_cv.notify_all();
+
+            if (self) {
+                __help(*self, j);
+            } else {
+                std::unique_lock<std::mutex> lock(j.mutex);
+                j.cv.wait(lock, [&j] { return j.pending == 0; });
+            }
+
+            if (j.error)
+                std::rethrow_exception(j.error);
+        }
+
+    private:
+        // one parallel_for call, it lives on the stack of the calling thread
+        struct job {
+            void (*run)(void *clb, unsigned long lo, unsigned long hi);
+            void *clb;
+            unsigned long begin, n, chunks, pending;
+            bool helped;        // the caller is a worker waiting in __help
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::exception_ptr error;
+        };
+
+        struct chunk {
+            job *owner;
+            unsigned long index;
+            chunk *next;
+        };
+
+        struct worker {
+            executor *pool = nullptr;
+            std::thread thread;
+            std::deque<std::function<void()>> tasks;
+            chunk *head = nullptr;
+            chunk *tail = nullptr;
+            bool busy = false;
+        };
+
+        std::vector<std::unique_ptr<worker>> m_workers;
+        std::deque<std::function<void()>> m_shared;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_stop = false;
+
+        // worker running on the calling thread, whichever pool it belongs to
+        static worker *&__current() {
+            static thread_local worker *current = nullptr;
+            return current;
+        }
+
+        struct level {
+            std::unique_ptr<chunk[]> nodes;
+            unsigned long size = 0;
+        };
+
+        // chunk nodes of one parallel_for call, kept per thread and nesting depth.
+        // a worker waiting for its chunks may run chunks that call parallel_for
+        // again, every depth has its own nodes. once grown to the pool size they
+        // are reused, so parallel_for stops allocating.
+        struct frame {
+            explicit frame(unsigned long n) : depth(__depth()++) {
+                auto &levels = __levels();
+
+                if (levels.size() <= depth)
+                    levels.resize(depth + 1);
+
+                auto &l = levels[depth];
+
+                if (n > l.size) {
+                    l.nodes.reset(new chunk[n]);
+                    l.size = n;
+                }
+
+                nodes = l.nodes.get();
+            }
+
+            ~frame() { --__depth(); }
+
+            unsigned long depth;
+            chunk *nodes;
+        };
+
+        static unsigned long &__depth() {
+            static thread_local unsigned long depth = 0;
+            return depth;
+        }
+
+        static std::vector<level> &__levels() {
+            static thread_local std::vector<level> levels;
+            return levels;
+        }
+
+        template<typename callback>
+        static void __invoke(void *clb, unsigned long lo, unsigned long hi) {
+            (*static_cast<callback *>(clb))(lo, hi);
+        }
+
+        static void __push(worker &w, chunk *c) {
+            c->next = nullptr;
+
+            if (w.tail) w.tail->next = c;
+            else w.head = c;
+
+            w.tail = c;
+        }
+
+        static chunk *__pop(worker &w) {
+            auto c = w.head;
+
+            w.head = c->next;
+            if (!w.head) w.tail = nullptr;
+
+            return c;
+        }
+
+        // a worker whose queued chunks wait behind the work it is running
+        worker *__victim() {
+            for (auto &w : m_workers) {
+                if (w->busy && w->head) return w.get();
+            }
+
+            return nullptr;
+        }
+
+        void __execute(chunk &c) {
+            auto &j = *c.owner;
+            auto lo = j.begin + j.n * c.index / j.chunks;
+            auto hi = j.begin + j.n * (c.index + 1) / j.chunks;
+            auto helped = j.helped;
+            bool last;
+            std::exception_ptr e;
+
+            try {
+                j.run(j.clb, lo, hi);
+            } catch (...) {
+                e = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(j.mutex);
+                if (e && !j.error) j.error = e;
+                last = --j.pending == 0;
+                if (last && !helped) j.cv.notify_one();
+            }
+
+            // a helping worker waits on the pool, j may be gone once it is woken
+            if (last && helped) {
+                { std::lock_guard<std::mutex> lock(m_mutex); }
+                m_cv.notify_all();
+            }
+        }
+
+        static bool __finished(job &j) {
+            std::lock_guard<std::mutex> lock(j.mutex);
+            return j.pending == 0;
+        }
+
+        // runs chunks queued on w, or stolen from busy workers, until j is done.
+        // w stays busy, so the chunks left in its own queue can be stolen too.
+        void __help(worker &w, job &j) {
+            for (;;) {
+                chunk *c;
+                bool stealable;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+
+                    m_cv.wait(lock, [&] { return __finished(j) || w.head || __victim(); });
+
+                    if (__finished(j))
+                        return;
+
+                    c = w.head ? __pop(w) : __pop(*__victim());
+                    stealable = w.head != nullptr;
+                }
+
+                if (stealable) m_cv.notify_all();
+
+                __execute(*c);
+            }
+        }
+
+        void __run(worker &w) {
+            __current() = &w;
+
+            for (;;) {
+                chunk *c = nullptr;
+                std::function<void()> task;
+                bool stealable;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    w.busy = false;
+
+                    m_cv.wait(lock, [&] {
+                        return m_stop || w.head || !w.tasks.empty() || !m_shared.empty() || __victim();
+                    });
+
+                    if (w.head) {
+                        c = __pop(w);
+                    } else if (!w.tasks.empty()) {
+                        task = std::move(w.tasks.front());
+                        w.tasks.pop_front();
+                    } else if (!m_shared.empty()) {
+                        task = std::move(m_shared.front());
+                        m_shared.pop_front();
+                    } else if (auto victim = __victim()) {
+                        c = __pop(*victim);
+                    } else {
+                        return;
+                    }
+
+                    w.busy = true;
+                    stealable = w.head != nullptr;
+                }
+
+                // chunks still queued here can be stolen from now on
+                if (stealable) m_cv.notify_all();
+
+                if (c) __execute(*c);
+                else task();
+            }
+        }
+    };
+
+    ///////////////
+    // workspace //
+    ///////////////
+
+    // scratch memory kept alive between calls. a buffer borrowed from a slot stays
+    // valid until the next borrow from the same slot and only grows until trimmed,
+    // so a loop repeating the same operations stops allocating after its first
+    // pass. kernels running on the pool borrow from the workspace of the worker,
+    // those stop growing once every worker has run a chunk of the operation.
+    class workspace {
+    public:
+        workspace() {}
+
+        workspace(const workspace &) = delete;
+
+        workspace &operator=(const workspace &) = delete;
+
+        // room for n values of T, the contents are unspecified
+        template<class T>
+        T *borrow(unsigned long slot, unsigned long n) {
+            static_assert(std::is_trivially_destructible<T>::value, "workspace only holds trivial types");
+
+            if (slot >= m_slots.size())
+                m_slots.resize(slot + 1);
+
+            auto &s = m_slots[slot];
+            auto bytes = n * sizeof(T);
+
+            if (bytes > s.size) {
+                s.data.reset(new unsigned char[bytes]);
+                s.size = bytes;
+            }
+
+            return reinterpret_cast<T *>(s.data.get());
+        }
+
+        // bytes held over all slots
+        unsigned long capacity() const {
+            unsigned long ret = 0;
+
+            for (auto &s : m_slots) {
+                ret += s.size;
+            }
+
+            return ret;
+        }
+
+        // frees every slot holding more than bytes, so one unusually large call
+        // does not keep its buffers for the lifetime of the thread
+        void trim(unsigned long bytes = 0) {
+            for (auto &s : m_slots) {
+                if (s.size > bytes) {
+                    s.data.reset();
+                    s.size = 0;
+                }
+            }
+        }
+
+        void release() {
+            m_slots.clear();
+            m_slots.shrink_to_fit();
+        }
+
+        // workspace of the calling thread, used whenever none is passed
+        static workspace &local() {
+            static thread_local workspace ws;
+            return ws;
+        }
+
+    private:
+        struct slot {
+            std::unique_ptr<unsigned char[]> data;
+            unsigned long size = 0;
+        };
+
+        std::vector<slot> m_slots;
+    };
+
+    /////////////
+    // kernels //
+    /////////////
+
+    namespace kernel {
+        // least number of elements per chunk of the elementwise kernels. fill uses
+        // the same one, so every chunk is first touched by the worker computing it.
+        constexpr unsigned long grain = 1ul << 15;
+
+        // identities of min and max folds. infinities where T has them, so lines
+        // holding only infinities reduce to the infinity itself.
+        template<class T>
+        T highest() {
+            return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::max();
+        }
+
+        template<class T>
+        T lowest() {
+            return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::lowest();
+        }
+
+        // writes value to every element of data, the pages are touched according to
+        // the placement policy
+        template<class T>
+        void fill(buffer_t<T> &data, T value, placement policy = get_placement()) {
+            auto &ex = executor::instance();
+            auto n = data.size();
+
+            // bits of vector<bool> share words, only one thread may write them
+            if (policy == placement::local || std::is_same<T, bool>::value || n <= grain) {
+                std::fill(data.begin(), data.end(), value);
+            } else if (policy == placement::first_touch) {
+                ex.parallel_for(0, n, [&](unsigned long lo, unsigned long hi) {
+                    std::fill(data.begin() + lo, data.begin() + hi, value);
+                }, grain);
+            } else {
+                auto page = std::max(1ul, 4096ul / sizeof(T));
+                auto pages = (n + page - 1) / page;
+                auto workers = ex.size();
+
+                ex.parallel_for(0, workers, [&](unsigned long lo, unsigned long hi) {
+                    for (unsigned long w = lo; w < hi; ++w) {
+                        for (unsigned long p = w; p < pages; p += workers) {
+                            std::fill(data.begin() + p * page, data.begin() + std::min(n, (p + 1) * page), value);
+                        }
+                    }
+                });
+            }
+        }
+
+        // cache blocking of gemm: a is packed in mc x kc blocks, b in kc x nc panels
+        constexpr unsigned long gemm_mc = 64;
+        constexpr unsigned long gemm_kc = 256;
+        constexpr unsigned long gemm_nc = 1024;
+
+        // the n x nc panel is further split in nr wide strips, so the work can be
+        // spread over the pool even when m fits in a single mc block
+        constexpr unsigned long gemm_nr = 256;
+
+        // workspace slots of gemm, the a block and row are borrowed per worker
+        constexpr unsigned long gemm_slot_b = 0;
+        constexpr unsigned long gemm_slot_a = 1;
+        constexpr unsigned long gemm_slot_row = 2;
+
+        // c = alpha * a * b + beta * c with a: m x k, b: k x n and c: m x n. every
+        // operand is described by its row and column stride, so transposed views
+        // are multiplied without copying them first. c is scaled by the worker
+        // computing its tile in the first kc panel, so an uninitialized c is first
+        // touched by that worker.
+        template<class T>
+        void gemm(unsigned long m, unsigned long n, unsigned long k, T alpha,
+                  const T *a, unsigned long a_rs, unsigned long a_cs,
+                  const T *b, unsigned long b_rs, unsigned long b_cs,
+                  T beta, T *c, unsigned long c_rs, unsigned long c_cs, workspace &ws = workspace::local()) {
+            auto &ex = executor::instance();
+
+            if (k == 0 || alpha == T()) {
+                ex.parallel_for(0, m, [&](unsigned long lo, unsigned long hi) {
+                    for (unsigned long i = lo; i < hi; ++i) {
+                        for (unsigned long j = 0; j < n; ++j) {
+                            auto &val = c[i * c_rs + j * c_cs];
+                            val = beta == T() ? T() : beta * val;
+                        }
+                    }
+                }, std::max(1ul, grain / std::max(n, 1ul)));
+
+                return;
+            }
+
+            for (unsigned long jc = 0; jc < n; jc += gemm_nc) {
+                auto nc = std::min(gemm_nc, n - jc);
+
+                for (unsigned long pc = 0; pc < k; pc += gemm_kc) {
+                    auto kc = std::min(gemm_kc, k - pc);
+
+                    auto packed_b = ws.borrow<T>(gemm_slot_b, kc * nc);
+                    auto first = pc == 0;
+
+                    // every tile reads the whole panel, so it is packed in a pass of its own
+                    ex.parallel_for(0, kc, [&](unsigned long lo, unsigned long hi) {
+                        for (unsigned long p = lo; p < hi; ++p) {
+                            for (unsigned long j = 0; j < nc; ++j) {
+                                packed_b[p * nc + j] = b[(pc + p) * b_rs + (jc + j) * b_cs];
+                            }
+                        }
+                    }, std::max(1ul, grain / nc));
+
+                    auto blocks = (m + gemm_mc - 1) / gemm_mc;
+                    auto strips = (nc + gemm_nr - 1) / gemm_nr;
+
+                    // task t is strip t % strips of row block t / strips, a chunk of
+                    // consecutive tasks packs every row block it meets only once
+                    ex.parallel_for(0, blocks * strips, [&](unsigned long lo, unsigned long hi) {
+                        auto &local = workspace::local();
+                        auto packed_a = local.borrow<T>(gemm_slot_a, gemm_mc * kc);
+                        auto row = local.borrow<T>(gemm_slot_row, gemm_nr);
+                        auto packed = blocks;
+
+                        for (unsigned long t = lo; t < hi; ++t) {
+                            auto blk = t / strips;
+                            auto ic = blk * gemm_mc;
+                            auto mc = std::min(gemm_mc, m - ic);
+                            auto jr = (t % strips) * gemm_nr;
+                            auto nr = std::min(gemm_nr, nc - jr);
+
+                            if (blk != packed) {
+                                for (unsigned long i = 0; i < mc; ++i) {
+                                    for (unsigned long p = 0; p < kc; ++p) {
+                                        packed_a[i * kc + p] = a[(ic + i) * a_rs + (pc + p) * a_cs];
+                                    }
+                                }
+
+                                packed = blk;
+                            }
+
+                            for (unsigned long i = 0; i < mc; ++i) {
+                                std::fill(row, row + nr, T());
+
+                                for (unsigned long p = 0; p < kc; ++p) {
+                                    auto val = packed_a[i * kc + p];
+                                    auto src = &packed_b[p * nc + jr];
+
+                                    for (unsigned long j = 0; j < nr; ++j) {
+                                        row[j] += val * src[j];
+                                    }
+                                }
+
+                                auto dst = c + (ic + i) * c_rs + (jc + jr) * c_cs;
+
+                                if (!first) {
+                                    for (unsigned long j = 0; j < nr; ++j) {
+                                        dst[j * c_cs] += alpha * row[j];
+                                    }
+                                } else if (beta == T()) {
+                                    for (unsigned long j = 0; j < nr; ++j) {
+                                        dst[j * c_cs] = alpha * row[j];
+                                    }
+                                } else {
+                                    for (unsigned long j = 0; j < nr; ++j) {
+                                        dst[j * c_cs] = beta * dst[j * c_cs] + alpha * row[j];
+                                    }
+                                }
+                            }
+                        }
+                    }, std::max(1ul, (1ul << 16) / (kc * gemm_nr)));
+                }
+            }
+        }
+
+        // in place iterative radix-2 fft over n (a power of two) values spaced by stride
+        inline void fft(std::complex<double> *data, unsigned long n, unsigned long stride, bool inverse) {
+            for (unsigned long i = 1, j = 0; i < n; ++i) {
+                auto bit = n >> 1;
+
+                for (; j & bit; bit >>= 1) {
+                    j ^= bit;
+                }
+
+                j ^= bit;
+
+                if (i < j)
+                    std::swap(data[i * stride], data[j * stride]);
+            }
+
+            const double pi = 3.14159265358979323846;
+
+            for (unsigned long len = 2; len <= n; len <<= 1) {
+                auto angle = 2 * pi / len * (inverse ? 1 : -1);
+                std::complex<double> wlen(std::cos(angle), std::sin(angle));
+
+                for (unsigned long i = 0; i < n; i += len) {
+                    std::complex<double> w(1);
+
+                    for (unsigned long j = 0; j < len / 2; ++j) {
+                        auto u = data[(i + j) * stride];
+                        auto v = data[(i + j + len / 2) * stride] * w;
+
+                        data[(i + j) * stride] = u + v;
+                        data[(i + j + len / 2) * stride] = u - v;
+                        w *= wlen;
+                    }
+                }
+            }
+
+            if (inverse) {
+                for (unsigned long i = 0; i < n; ++i) {
+                    data[i * stride] /= static_cast<double>(n);
+                }
+            }
+        }
+
+        // 2-d fft of a row major rows x cols buffer, both powers of two
+        inline void fft2(std::complex<double> *data, unsigned long rows, unsigned long cols, bool inverse) {
+            executor::instance().parallel_for(0, rows, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long r = lo; r < hi; ++r) fft(data + r * cols, cols, 1, inverse);
+            });
+
+            executor::instance().parallel_for(0, cols, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long c = lo; c < hi; ++c) fft(data + c, rows, cols, inverse);
+            });
+        }
+    }
+
+    template<class T>
+    class array;
+
+    namespace kernel {
+        // writable element storage for the library kernels. arrays only hand out
+        // their buffer as const, resizing it would break the shape.
+        struct access {
+            template<class T>
+            static buffer_t<T> &data(array<T> &a) {
+                return a.m_data;
+            }
+        };
+    }
+
     template<class T>
     class array {
         using this_type = array<T>;
@@ -45,7 +812,8 @@ namespace nd {
 
         using shape_t = std::deque<unsigned long>;
         using strides_t = std::deque<unsigned long>;
-        using vector_t = std::vector<T>;
+        using vector_t = buffer_t<T>;
+        using mean_t = typename std::conditional<std::is_integral<T>::value, double, T>::type;
 
         //////////////////////
         // friend operators //
@@ -83,7 +851,7 @@ namespace nd {
                   m_shape(other.m_shape),
                   m_strides(other.m_strides),
                   m_base(nullptr),
-                  m_offset(offset) {
+                  m_offset(other.m_offset + offset) {
         }
 
         array(T &&val, unsigned long offset = 0)
@@ -100,19 +868,27 @@ namespace nd {
                 : m_type(value_t::array),
                   m_base(nullptr) {
 
-            m_shape.emplace_front(list.size());
+            unsigned long size = 0;
+
+            for (auto &val : list) {
+                size += val.m_type == value_t::scalar ? 1 : val.data().size();
+            }
+
+            m_data.reserve(size);
 
             for (auto &val : list) {
                 if (val.m_type == value_t::scalar) { // construct individual elements form list
                     m_data.push_back(val.m_data.at(0));
-                    __set_strides(m_shape);
                 } else { // add values to the actual object
                     m_data.insert(std::end(m_data), std::begin(val.data()), std::end(val.data()));
-                    m_shape = val.shape();
-                    m_shape.emplace_front(list.size());
-                    __set_strides(m_shape);
                 }
             }
+
+            if (list.size() != 0 && list.begin()->m_type != value_t::scalar)
+                m_shape = list.begin()->shape();
+
+            m_shape.emplace_front(list.size());
+            __set_strides(m_shape);
         }
 
         array(const shape_t &shape, T init)
@@ -120,19 +896,24 @@ namespace nd {
                   m_type(value_t::array) {
             auto size = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<unsigned long>());
 
-            m_data = vector_t(size, init);
+            m_data = vector_t(size);
+            kernel::fill(m_data, init);
 
             __set_strides(m_shape);
         }
 
-//        array(const vector_t &data, const shape_t &shape, this_type *base)
-//                : m_type(value_t::array),
-//                  m_data(data),
-//                  m_shape(shape),
-//                  m_base(base)
-//        {
-//            __set_strides(shape);
-//        }
+        // takes over an existing buffer laid out in row major order
+        array(vector_t data, const shape_t &shape)
+                : m_type(value_t::array),
+                  m_data(std::move(data)),
+                  m_shape(shape) {
+            auto size = std::accumulate(shape.begin(), shape.end(), 1ul, std::multiplies<unsigned long>());
+
+            if (size != m_data.size())
+                throw std::invalid_argument("buffer size does not match the shape");
+
+            __set_strides(m_shape);
+        }
 
         ~array() {}
 
@@ -177,7 +958,7 @@ namespace nd {
 
         unsigned long rows() const { return *m_shape.begin(); }
 
-        unsigned long columns() const { return *m_shape.end(); }
+        unsigned long columns() const { return m_shape.back(); }
 
         const strides_t &strides() const { return m_strides; }
 
@@ -197,6 +978,22 @@ namespace nd {
 
         bool is_array() const { return m_type == value_t::array; }
 
+        bool is_contiguous() const {
+            if (m_type == value_t::scalar)
+                return true;
+
+            unsigned long expected = 1;
+
+            for (int i = (int) (m_shape.size() - 1); i >= 0; --i) {
+                if (m_shape.at(i) != 1 && m_strides.at(i) != expected)
+                    return false;
+
+                expected *= m_shape.at(i);
+            }
+
+            return true;
+        }
+
         template<typename R>
         R get() {
 
@@ -273,12 +1070,26 @@ namespace nd {
         }
 
         void arrange(unsigned long start, unsigned long end, T step = 1) {
-            for (auto &val : m_data) {
-                if (start < end) {
-                    val = start;
-                    start += step;
+            if (!(step > 0)) {
+                for (auto &val : m_data) {
+                    if (start < end) {
+                        val = start;
+                        start += step;
+                    }
                 }
+
+                return;
             }
+
+            // the i-th value is known up front, so the slots are written in parallel
+            auto count = start < end ? (unsigned long) std::ceil((end - start) / (double) step) : 0ul;
+            count = std::min(count, (unsigned long) m_data.size());
+
+            executor::instance().parallel_for(0, count, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long i = lo; i < hi; ++i) {
+                    m_data[i] = static_cast<T>(start + i * step);
+                }
+            }, kernel::grain);
         }
 
         this_type transpose(const shape_t &permute = {}) const {
@@ -325,32 +1136,114 @@ namespace nd {
         }
 
         this_type dot(const_reference other) const {
-            if(ndim() == 1) {
-                if(size() != other.size()) throw std::runtime_error("shapes are not aligned for dot product");
-                return this_type(std::inner_product(m_data.begin(), m_data.end(), other.m_data.begin(), 0));
-            } else if(ndim() == 2) {
-                double tmp {};
-                auto n = rows();
-                this_type ret({n, other.columns()}, 0.);
+            if (ndim() == 1) {
+                this_type ret(T(0));
+                dot(other, ret);
 
-                for (unsigned long i = 0; i < n; i++) {
-                    for (unsigned long k = 0; k < other.columns(); k++) {
-                        tmp = 0;
-                        for (unsigned long j = 0; j < other.rows(); j++) {
-                            tmp += item({i, j}) * other.item({j, k});
-                        }
-                        ret.item({i, k}) = tmp;
-                    }
-                }
+                return ret;
+            } else if (ndim() == 2) {
+                if (other.ndim() != 2 || columns() != other.rows())
+                    throw std::runtime_error("shapes are not aligned for dot product");
+
+                this_type ret(vector_t(rows() * other.columns()), shape_t{rows(), other.columns()});
+                dot(other, ret);
 
                 return ret;
             } else {
-
+                throw std::invalid_argument("dot is only implemented for 1-d and 2-d arrays");
             }
         }
 
-        ////////////////
-        //  modifiers //
+        // dot product written into out, which must already have the shape of the
+        // result. gemm borrows its packing buffers from ws, so a loop over the
+        // same shapes runs without allocating once ws has grown.
+        reference dot(const_reference other, reference out, workspace &ws = workspace::local()) const {
+            if (&out == this || &out == &other)
+                throw std::invalid_argument("output array must not be one of the inputs");
+
+            if (out.m_base != nullptr)
+                throw std::invalid_argument("output array must not be a view");
+
+            if (ndim() == 1) {
+                if (ndim() != other.ndim() || rows() != other.rows())
+                    throw std::runtime_error("shapes are not aligned for dot product");
+
+                if (out.__count() != 1)
+                    throw std::invalid_argument("output array has the wrong shape");
+
+                T sum = T();
+
+                for (unsigned long i = 0; i < rows(); ++i) {
+                    sum += m_data[m_offset + i * m_strides[0]] * other.m_data[other.m_offset + i * other.m_strides[0]];
+                }
+
+                out.m_data[out.m_offset] = sum;
+
+                return out;
+            } else if (ndim() == 2) {
+                if (other.ndim() != 2 || columns() != other.rows())
+                    throw std::runtime_error("shapes are not aligned for dot product");
+
+                auto n = rows();
+
+                if (out.ndim() != 2 || out.m_shape[0] != n || out.m_shape[1] != other.columns())
+                    throw std::invalid_argument("output array has the wrong shape");
+
+                kernel::gemm(n, other.columns(), columns(), T(1),
+                             m_data.data() + m_offset, m_strides[0], m_strides[1],
+                             other.m_data.data() + other.m_offset, other.m_strides[0], other.m_strides[1],
+                             T(), out.m_data.data() + out.m_offset, out.m_strides[0], out.m_strides[1], ws);
+
+                return out;
+            } else {
+                throw std::invalid_argument("dot is only implemented for 1-d and 2-d arrays");
+            }
+        }
+
+        // copy of the elements in logical order as a 1-d array
+        this_type flatten() const {
+            vector_t data;
+            data.reserve(__count());
+
+            if (m_type == value_t::scalar) {
+                data.push_back(m_data.at(m_offset));
+            } else if (is_contiguous()) {
+                data.assign(m_data.begin() + m_offset, m_data.begin() + m_offset + __count());
+            } else {
+                __walk(*this, [&](unsigned long a, unsigned long) {
+                    data.push_back(m_data[a]);
+                    return true;
+                });
+            }
+
+            return this_type(std::move(data), {__count()});
+        }
+
+        // every window of the given shape as a view: the result has the window
+        // positions as leading dimensions and the window itself as trailing ones.
+        // only the strides change, the elements are not duplicated per window.
+        this_type sliding_window_view(const shape_t &window) const {
+            if (m_type == value_t::scalar || window.size() != ndim())
+                throw std::invalid_argument("window shape must have one entry per dimension");
+
+            auto ret = *this;
+
+            ret.m_base = m_base == nullptr ? const_cast<this_type *>(this) : m_base;
+
+            for (unsigned long i = 0; i < ndim(); ++i) {
+                if (window.at(i) == 0 || window.at(i) > m_shape.at(i))
+                    throw std::invalid_argument("window shape cannot be larger than the input");
+
+                ret.m_shape.at(i) = m_shape.at(i) - window.at(i) + 1;
+                ret.m_shape.push_back(window.at(i));
+                ret.m_strides.push_back(m_strides.at(i));
+            }
+
+            return ret;
+        }
+
+        ////////////////
+        //  modifiers //
         ////////////////
 
         void swap(reference other) {
@@ -408,35 +1301,36 @@ namespace nd {
 
         void random(int min, int max) {
             std::random_device rd;
-            std::mt19937 rng(rd());
-            std::uniform_real_distribution<T> uni(-1, 1);
+            auto seed = rd();
 
-            for (auto &val : m_data) {
-                val = uni(rng);
-            }
+            // every chunk draws from its own generator so pages are first touched by their worker
+            executor::instance().parallel_for(0, m_data.size(), [&](unsigned long lo, unsigned long hi) {
+                std::mt19937 rng(seed ^ static_cast<unsigned int>(lo));
+                std::uniform_real_distribution<T> uni(-1, 1);
+
+                for (unsigned long i = lo; i < hi; ++i) {
+                    m_data[i] = uni(rng);
+                }
+            }, kernel::grain);
         }
 
         bool operator==(const_reference other) const {
-            if (!std::equal(m_shape.begin(), m_shape.end(), other.shape().begin()) ||
-                m_type != other.type())
+            if (m_type != other.type())
                 return false;
 
-            ///TBD: check if values are equal
-            if (m_type == value_t::scalar) {
-                return other.data().at(other.offset()) == m_data.at(m_offset);
-            } else if (m_shape.size() == 1) {
-                for (unsigned long i = 0; i < m_shape.at(0); ++i) {
-                    if (at(i) == other.at(i));
-                    else return false;
-                }
-            } else {
-                for (int i = 0; i < rows(); ++i) {
-                    if (at(i) == other.at(i));
-                    else return false;
-                }
-            }
+            if (m_type == value_t::scalar)
+                return other.m_data.at(other.m_offset) == m_data.at(m_offset);
 
-            return true;
+            if (m_shape != other.m_shape)
+                return false;
+
+            // both sides are laid out the same way, compare the raw ranges
+            if (is_contiguous() && other.is_contiguous())
+                return __equal_range(other, __is_memcmp_comparable());
+
+            return __walk(other, [&](unsigned long a, unsigned long b) {
+                return m_data[a] == other.m_data[b];
+            });
         }
 
         bool operator!=(const_reference other) const {
@@ -460,38 +1354,365 @@ namespace nd {
         ///////////////////////////
 
         const_reference operator+=(T val) {
-            return unary_expr([&val](double v) { return v + val; });;
+            return __elementwise([&val](double v) { return v + val; });
         }
 
         const_reference operator+=(const_reference other) {
-            return unary_expr(other, std::plus<T>());;
+            return __elementwise(other, std::plus<T>());
         }
 
         const_reference operator-=(T val) {
-            return unary_expr([&val](double v) { return v - val; });;
+            return __elementwise([&val](double v) { return v - val; });
         }
 
         const_reference operator-=(const_reference other) {
-            return unary_expr(other, std::minus<T>());;
+            return __elementwise(other, std::minus<T>());
         }
 
         const_reference operator*=(T val) {
-            return unary_expr([&val](double v) { return v * val; });;
+            return __elementwise([&val](double v) { return v * val; });
         }
 
         const_reference operator*=(const_reference other) {
-            return unary_expr(other, std::multiplies<T>());;
+            return __elementwise(other, std::multiplies<T>());
         }
 
         const_reference operator/=(T val) {
-            return unary_expr([&val](double v) { return v / val; });;
+            return __elementwise([&val](double v) { return v / val; });
         }
 
         const_reference operator/=(const_reference other) {
-            return unary_expr(other, std::divides<T>());;
+            return __elementwise(other, std::divides<T>());
+        }
+
+        ///////////////////////////
+        //  comparison operators //
+        ///////////////////////////
+
+        array<bool> equal(const_reference other) const {
+            return __compare(other, std::equal_to<T>());
+        }
+
+        array<bool> equal(T val) const {
+            return __compare(val, std::equal_to<T>());
+        }
+
+        array<bool> not_equal(const_reference other) const {
+            return __compare(other, std::not_equal_to<T>());
+        }
+
+        array<bool> not_equal(T val) const {
+            return __compare(val, std::not_equal_to<T>());
+        }
+
+        array<bool> less(const_reference other) const {
+            return __compare(other, std::less<T>());
+        }
+
+        array<bool> less(T val) const {
+            return __compare(val, std::less<T>());
+        }
+
+        array<bool> less_equal(const_reference other) const {
+            return __compare(other, std::less_equal<T>());
+        }
+
+        array<bool> less_equal(T val) const {
+            return __compare(val, std::less_equal<T>());
+        }
+
+        array<bool> greater(const_reference other) const {
+            return __compare(other, std::greater<T>());
+        }
+
+        array<bool> greater(T val) const {
+            return __compare(val, std::greater<T>());
+        }
+
+        array<bool> greater_equal(const_reference other) const {
+            return __compare(other, std::greater_equal<T>());
+        }
+
+        array<bool> greater_equal(T val) const {
+            return __compare(val, std::greater_equal<T>());
+        }
+
+        // elementwise |a - b| <= atol + rtol * |b|, same definition as numpy
+        array<bool> isclose(const_reference other, double rtol = 1e-05, double atol = 1e-08,
+                            bool equal_nan = false) const {
+            return __compare(other, [rtol, atol, equal_nan](const T &a, const T &b) {
+                return __close(a, b, rtol, atol, equal_nan);
+            });
+        }
+
+        // true when isclose holds everywhere, incompatible shapes throw like isclose
+        bool allclose(const_reference other, double rtol = 1e-05, double atol = 1e-08,
+                      bool equal_nan = false) const {
+            if (m_type == value_t::scalar || other.m_type == value_t::scalar) {
+                if (m_type != other.m_type)
+                    throw std::invalid_argument("operands could not be broadcast together");
+
+                return __close(m_data.at(m_offset), other.m_data.at(other.m_offset), rtol, atol, equal_nan);
+            }
+
+            if (m_shape != other.m_shape)
+                throw std::invalid_argument("operands could not be broadcast together");
+
+            return __walk(other, [&](unsigned long a, unsigned long b) {
+                return __close(m_data[a], other.m_data[b], rtol, atol, equal_nan);
+            });
+        }
+
+        ////////////////
+        // reductions //
+        ////////////////
+
+        T sum() const {
+            return __reduce(T(), std::plus<T>());
+        }
+
+        this_type sum(int axis) const {
+            return __reduce(axis, T(), std::plus<T>());
+        }
+
+        T min() const {
+            if (__count() == 0) throw std::invalid_argument("zero-size array has no minimum");
+            return __reduce(kernel::highest<T>(), &this_type::__min);
+        }
+
+        this_type min(int axis) const {
+            if (__count() == 0) throw std::invalid_argument("zero-size array has no minimum");
+            return __reduce(axis, kernel::highest<T>(), &this_type::__min);
+        }
+
+        T max() const {
+            if (__count() == 0) throw std::invalid_argument("zero-size array has no maximum");
+            return __reduce(kernel::lowest<T>(), &this_type::__max);
+        }
+
+        this_type max(int axis) const {
+            if (__count() == 0) throw std::invalid_argument("zero-size array has no maximum");
+            return __reduce(axis, kernel::lowest<T>(), &this_type::__max);
+        }
+
+        // integer arrays are averaged in double, like numpy
+        mean_t mean() const {
+            return static_cast<mean_t>(sum()) / static_cast<mean_t>(__count());
+        }
+
+        array<mean_t> mean(int axis) const {
+            auto ret = __reduce(axis, mean_t(), &this_type::__add_mean);
+            auto n = static_cast<mean_t>(m_shape.at(__axis(axis)));
+
+            for (auto &val : ret.m_data) {
+                val /= n;
+            }
+
+            return ret;
+        }
+
+        // reductions along axis written into out, which must be contiguous and have
+        // the reduced shape. the line offsets are kept in ws between calls.
+        reference sum(int axis, reference out, workspace &ws = workspace::local()) const {
+            return __reduce(axis, T(), std::plus<T>(), out, ws);
+        }
+
+        reference min(int axis, reference out, workspace &ws = workspace::local()) const {
+            if (__count() == 0) throw std::invalid_argument("zero-size array has no minimum");
+            return __reduce(axis, kernel::highest<T>(), &this_type::__min, out, ws);
+        }
+
+        reference max(int axis, reference out, workspace &ws = workspace::local()) const {
+            if (__count() == 0) throw std::invalid_argument("zero-size array has no maximum");
+            return __reduce(axis, kernel::lowest<T>(), &this_type::__max, out, ws);
+        }
+
+        array<mean_t> &mean(int axis, array<mean_t> &out, workspace &ws = workspace::local()) const {
+            __reduce(axis, mean_t(), &this_type::__add_mean, out, ws);
+
+            auto n = static_cast<mean_t>(m_shape.at(__axis(axis)));
+            auto data = out.m_data.data() + out.m_offset;
+
+            for (unsigned long i = 0; i < out.__count(); ++i) {
+                data[i] /= n;
+            }
+
+            return out;
+        }
+
+        /////////////
+        // sorting //
+        /////////////
+
+        // sorts every line along axis independently, in place. nan goes last.
+        void sort(int axis = -1) {
+            auto ax = __axis(axis);
+            auto n = m_shape.at(ax);
+            auto stride = m_strides.at(ax);
+            auto lines = __lines(ax);
+
+            executor::instance().parallel_for(0, lines.size(), [&](unsigned long lo, unsigned long hi) {
+                std::vector<T> buffer(n);
+                std::vector<T> scratch(__is_radix_sortable::value && n >= __radix_line ? n : 0);
+
+                for (unsigned long l = lo; l < hi; ++l) {
+                    __gather(lines[l], stride, n, buffer.data());
+                    __sort_line(buffer.data(), n, scratch.data(), __is_radix_sortable());
+                    __scatter(buffer.data(), lines[l], stride, n);
+                }
+            }, __line_grain(n));
+        }
+
+        array<unsigned long> argsort(int axis = -1) const {
+            auto ax = __axis(axis);
+            auto n = m_shape.at(ax);
+            auto stride = m_strides.at(ax);
+            auto lines = __lines(ax);
+
+            array<unsigned long> ret(m_shape, 0);
+            auto out_lines = ret.__lines(ax);
+            auto out_stride = ret.m_strides.at(ax);
+
+            executor::instance().parallel_for(0, lines.size(), [&](unsigned long lo, unsigned long hi) {
+                std::vector<T> values(n);
+                std::vector<unsigned long> index(n);
+
+                for (unsigned long l = lo; l < hi; ++l) {
+                    __gather(lines[l], stride, n, values.data());
+                    std::iota(index.begin(), index.end(), 0ul);
+
+                    // ties keep their original order, like a stable sort
+                    std::sort(index.begin(), index.end(), [&values](unsigned long a, unsigned long b) {
+                        return __lt(values[a], values[b]) || (!__lt(values[b], values[a]) && a < b);
+                    });
+
+                    for (unsigned long i = 0; i < n; ++i) {
+                        ret.m_data[out_lines[l] + i * out_stride] = index[i];
+                    }
+                }
+            }, __line_grain(n));
+
+            return ret;
+        }
+
+        // moves the kth element of every line to the position it would have when
+        // sorted, with smaller elements before it and larger ones after it
+        void partition(unsigned long kth, int axis = -1) {
+            auto ax = __axis(axis);
+            auto n = m_shape.at(ax);
+            auto stride = m_strides.at(ax);
+            auto lines = __lines(ax);
+
+            if (kth >= n)
+                throw std::invalid_argument("kth out of bounds");
+
+            executor::instance().parallel_for(0, lines.size(), [&](unsigned long lo, unsigned long hi) {
+                std::vector<T> buffer(n);
+
+                for (unsigned long l = lo; l < hi; ++l) {
+                    __gather(lines[l], stride, n, buffer.data());
+                    std::nth_element(buffer.begin(), buffer.begin() + kth, buffer.end(), &this_type::__lt);
+                    __scatter(buffer.data(), lines[l], stride, n);
+                }
+            }, __line_grain(n));
+        }
+
+        array<unsigned long> argpartition(unsigned long kth, int axis = -1) const {
+            auto ax = __axis(axis);
+            auto n = m_shape.at(ax);
+            auto stride = m_strides.at(ax);
+            auto lines = __lines(ax);
+
+            if (kth >= n)
+                throw std::invalid_argument("kth out of bounds");
+
+            array<unsigned long> ret(m_shape, 0);
+            auto out_lines = ret.__lines(ax);
+            auto out_stride = ret.m_strides.at(ax);
+
+            executor::instance().parallel_for(0, lines.size(), [&](unsigned long lo, unsigned long hi) {
+                std::vector<T> values(n);
+                std::vector<unsigned long> index(n);
+
+                for (unsigned long l = lo; l < hi; ++l) {
+                    __gather(lines[l], stride, n, values.data());
+                    std::iota(index.begin(), index.end(), 0ul);
+
+                    std::nth_element(index.begin(), index.begin() + kth, index.end(),
+                                     [&values](unsigned long a, unsigned long b) {
+                                         return __lt(values[a], values[b]);
+                                     });
+
+                    for (unsigned long i = 0; i < n; ++i) {
+                        ret.m_data[out_lines[l] + i * out_stride] = index[i];
+                    }
+                }
+            }, __line_grain(n));
+
+            return ret;
+        }
+
+        // the k largest (or smallest) elements of every line along axis, ordered
+        // best first, together with their indexes in the line
+        std::pair<this_type, array<unsigned long>> topk(unsigned long k, int axis = -1, bool largest = true) const {
+            auto ax = __axis(axis);
+            auto n = m_shape.at(ax);
+            auto stride = m_strides.at(ax);
+            auto lines = __lines(ax);
+
+            if (k > n)
+                throw std::invalid_argument("k is larger than the axis");
+
+            auto shape = m_shape;
+            shape.at(ax) = k;
+
+            this_type values(shape, T());
+            array<unsigned long> indexes(shape, 0);
+            auto out_lines = values.__lines(ax);
+            auto out_stride = values.m_strides.at(ax);
+
+            auto write = [&](unsigned long l, const std::vector<std::pair<T, unsigned long>> &best) {
+                for (unsigned long i = 0; i < k; ++i) {
+                    values.m_data[out_lines[l] + i * out_stride] = best[i].first;
+                    indexes.m_data[out_lines[l] + i * out_stride] = best[i].second;
+                }
+            };
+
+            if (k == 0)
+                return std::make_pair(values, indexes);
+
+            if (lines.size() < executor::instance().size() && n >= __parallel_line) {
+                // few long lines: split every line over the pool and merge the candidates
+                for (unsigned long l = 0; l < lines.size(); ++l) {
+                    std::mutex mutex;
+                    std::vector<std::pair<T, unsigned long>> candidates;
+
+                    executor::instance().parallel_for(0, n, [&](unsigned long lo, unsigned long hi) {
+                        auto best = __topk_line(lines[l], stride, lo, hi, k, largest);
+
+                        std::lock_guard<std::mutex> lock(mutex);
+                        candidates.insert(candidates.end(), best.begin(), best.end());
+                    }, std::max(k, __parallel_line / 4));
+
+                    __topk_select(candidates, k, largest);
+                    write(l, candidates);
+                }
+            } else {
+                executor::instance().parallel_for(0, lines.size(), [&](unsigned long lo, unsigned long hi) {
+                    for (unsigned long l = lo; l < hi; ++l) {
+                        write(l, __topk_line(lines[l], stride, 0, n, k, largest));
+                    }
+                }, __line_grain(n));
+            }
+
+            return std::make_pair(values, indexes);
         }
 
     private:
+        template<class U> friend class array;
+
+        friend struct kernel::access;
+
         value_t m_type = value_t::null;
         vector_t m_data;
         shape_t m_shape;
@@ -510,7 +1731,1683 @@ namespace nd {
                                                                   std::multiplies<unsigned long>());
             }
         }
-    };
+
+        // number of elements seen through the current shape
+        unsigned long __count() const {
+            if (m_type == value_t::scalar)
+                return 1;
+
+            return std::accumulate(m_shape.begin(), m_shape.end(), 1ul, std::multiplies<unsigned long>());
+        }
+
+        // walks this array and other (same shape) in logical order and hands the
+        // offsets of each element pair to clb. stops as soon as clb returns false.
+        template<typename callback>
+        bool __walk(const_reference other, callback clb) const {
+            auto n = ndim();
+            auto total = __count();
+
+            if (total == 0)
+                return true;
+
+            if (n == 0)
+                return clb(m_offset, other.m_offset);
+
+            auto inner = m_shape.back();
+            auto sa = m_strides.back();
+            auto sb = other.m_strides.back();
+            auto oa = m_offset;
+            auto ob = other.m_offset;
+            std::vector<unsigned long> index(n, 0);
+
+            for (unsigned long row = 0; row < total / inner; ++row) {
+                for (unsigned long i = 0; i < inner; ++i) {
+                    if (!clb(oa + i * sa, ob + i * sb))
+                        return false;
+                }
+
+                // advance the outer dimensions like an odometer
+                for (int d = (int) n - 2; d >= 0; --d) {
+                    oa += m_strides[d];
+                    ob += other.m_strides[d];
+
+                    if (++index[d] < m_shape[d])
+                        break;
+
+                    oa -= m_strides[d] * m_shape[d];
+                    ob -= other.m_strides[d] * m_shape[d];
+                    index[d] = 0;
+                }
+            }
+
+            return true;
+        }
+
+        using __is_memcmp_comparable = std::integral_constant<bool,
+                std::is_integral<T>::value && !std::is_same<T, bool>::value>;
+
+        // integers have no padding or nan, so the bytes can be compared directly
+        bool __equal_range(const_reference other, std::true_type) const {
+            return std::memcmp(m_data.data() + m_offset, other.m_data.data() + other.m_offset,
+                               __count() * sizeof(T)) == 0;
+        }
+
+        bool __equal_range(const_reference other, std::false_type) const {
+            auto first = m_data.begin() + m_offset;
+
+            return std::equal(first, first + __count(), other.m_data.begin() + other.m_offset);
+        }
+
+        template<typename callback>
+        array<bool> __compare(const_reference other, callback clb) const {
+            if (m_type == value_t::scalar || other.m_type == value_t::scalar) {
+                if (m_type != other.m_type)
+                    throw std::invalid_argument("operands could not be broadcast together");
+
+                return array<bool>(clb(m_data.at(m_offset), other.m_data.at(other.m_offset)));
+            }
+
+            if (m_shape != other.m_shape)
+                throw std::invalid_argument("operands could not be broadcast together");
+
+            array<bool> ret(m_shape, false);
+            unsigned long k = 0;
+
+            if (is_contiguous() && other.is_contiguous()) {
+                auto x = m_data.begin() + m_offset;
+                auto y = other.m_data.begin() + other.m_offset;
+
+                __mask(ret, [&](unsigned long i) { return clb(x[i], y[i]); });
+            } else {
+                __walk(other, [&](unsigned long a, unsigned long b) {
+                    ret.m_data[k++] = clb(m_data[a], other.m_data[b]);
+                    return true;
+                });
+            }
+
+            return ret;
+        }
+
+        template<typename callback>
+        array<bool> __compare(T val, callback clb) const {
+            if (m_type == value_t::scalar)
+                return array<bool>(clb(m_data.at(m_offset), val));
+
+            array<bool> ret(m_shape, false);
+            unsigned long k = 0;
+
+            if (is_contiguous()) {
+                auto x = m_data.begin() + m_offset;
+
+                __mask(ret, [&](unsigned long i) { return clb(x[i], val); });
+            } else {
+                __walk(*this, [&](unsigned long a, unsigned long) {
+                    ret.m_data[k++] = clb(m_data[a], val);
+                    return true;
+                });
+            }
+
+            return ret;
+        }
+
+        // ret[i] = clb(i) over the pool. the bits of array<bool> share 64 bit words,
+        // so chunks are whole words and each word is computed into a plain bool
+        // block first, which the compiler can vectorize, before it is stored.
+        template<typename callback>
+        static void __mask(array<bool> &ret, callback clb) {
+            auto total = ret.m_data.size();
+            auto words = (total + 63) / 64;
+
+            executor::instance().parallel_for(0, words, [&](unsigned long lo, unsigned long hi) {
+                bool block[64];
+
+                for (unsigned long w = lo; w < hi; ++w) {
+                    auto begin = w * 64;
+                    auto n = std::min(64ul, total - begin);
+
+                    for (unsigned long i = 0; i < n; ++i) {
+                        block[i] = clb(begin + i);
+                    }
+
+                    std::copy(block, block + n, ret.m_data.begin() + begin);
+                }
+            }, std::max(1ul, kernel::grain / 64));
+        }
+
+        static T __min(T a, T b) { return b < a ? b : a; }
+
+        static T __max(T a, T b) { return a < b ? b : a; }
+
+        static mean_t __add_mean(mean_t a, T b) { return a + static_cast<mean_t>(b); }
+
+        // unary_expr() split over the pool, only for stateless callbacks
+        template<typename callback>
+        const_reference __elementwise(callback clb) {
+            auto &data = m_base == nullptr ? m_data : m_base->m_data;
+
+            executor::instance().parallel_for(m_offset, m_offset + __count(), [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long i = lo; i < hi; ++i) {
+                    data[i] = clb(data[i]);
+                }
+            }, kernel::grain);
+
+            return *this;
+        }
+
+        template<typename callback>
+        const_reference __elementwise(const_reference other, callback clb) {
+            if (m_type != other.type() || size() != other.size())
+                throw std::invalid_argument("cannot perform unary_expr() if arrays are not equal");
+
+            executor::instance().parallel_for(0, size(), [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long i = lo; i < hi; ++i) {
+                    m_data[i] = clb(m_data[i], other.m_data[i]);
+                }
+            }, kernel::grain);
+
+            return *this;
+        }
+
+        // folds every element into init. contiguous arrays are cut in blocks of
+        // kernel::grain elements whose partials are folded in block order, so the
+        // result does not depend on the number of workers or on their timing.
+        template<typename callback>
+        T __reduce(T init, callback clb) const {
+            auto ret = init;
+
+            if (m_type == value_t::scalar)
+                return clb(ret, m_data.at(m_offset));
+
+            if (!is_contiguous()) {
+                __walk(*this, [&](unsigned long a, unsigned long) {
+                    ret = clb(ret, m_data[a]);
+                    return true;
+                });
+
+                return ret;
+            }
+
+            auto total = __count();
+            auto blocks = (total + kernel::grain - 1) / kernel::grain;
+            auto partials = workspace::local().borrow<T>(__slot_partials, blocks);
+
+            executor::instance().parallel_for(0, blocks, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long b = lo; b < hi; ++b) {
+                    auto first = m_offset + b * kernel::grain;
+                    auto last = std::min(m_offset + total, first + kernel::grain);
+                    auto partial = init;
+
+                    for (unsigned long i = first; i < last; ++i) {
+                        partial = clb(partial, m_data[i]);
+                    }
+
+                    partials[b] = partial;
+                }
+            });
+
+            for (unsigned long b = 0; b < blocks; ++b) {
+                ret = clb(ret, partials[b]);
+            }
+
+            return ret;
+        }
+
+        // folds every line along axis, the axis is removed from the result
+        template<class R, typename callback>
+        array<R> __reduce(int axis, R init, callback clb) const {
+            auto ax = __axis(axis);
+
+            auto shape = m_shape;
+            shape.erase(shape.begin() + ax);
+
+            if (shape.empty()) {
+                array<R> ret((R(init)));
+                __reduce(axis, init, clb, ret, workspace::local());
+
+                return ret;
+            }
+
+            auto out_size = std::accumulate(shape.begin(), shape.end(), 1ul, std::multiplies<unsigned long>());
+            array<R> ret(buffer_t<R>(out_size), shape);
+
+            __reduce(axis, init, clb, ret, workspace::local());
+
+            return ret;
+        }
+
+        template<class R, typename callback>
+        array<R> &__reduce(int axis, R init, callback clb, array<R> &out, workspace &ws) const {
+            auto ax = __axis(axis);
+            auto n = m_shape.at(ax);
+            auto stride = m_strides.at(ax);
+
+            if (static_cast<const void *>(&out) == this)
+                throw std::invalid_argument("output array must not be the input");
+
+            if (out.base() != nullptr)
+                throw std::invalid_argument("output array must not be a view");
+
+            if (!out.is_contiguous())
+                throw std::invalid_argument("output array must be contiguous");
+
+            if (ndim() == 1 ? out.__count() != 1 : !__is_reduced(ax, out))
+                throw std::invalid_argument("output array has the wrong shape");
+
+            auto count = n == 0 ? 0 : __count() / n;
+            auto lines = ws.borrow<unsigned long>(__slot_lines, count);
+            __lines(ax, lines, ws.borrow<unsigned long>(__slot_index, ndim()));
+
+            auto dst = out.m_data.data() + out.m_offset;
+
+            executor::instance().parallel_for(0, count, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long l = lo; l < hi; ++l) {
+                    auto val = init;
+
+                    for (unsigned long i = 0; i < n; ++i) {
+                        val = clb(val, m_data[lines[l] + i * stride]);
+                    }
+
+                    dst[l] = val;
+                }
+            }, __line_grain(n));
+
+            // every slot is its own identity when the axis is empty
+            if (n == 0) {
+                for (unsigned long i = 0; i < out.__count(); ++i) {
+                    dst[i] = init;
+                }
+            }
+
+            return out;
+        }
+
+        // true when out has this shape without axis
+        template<class R>
+        bool __is_reduced(unsigned long axis, const array<R> &other) const {
+            if (other.m_type == value_t::scalar || other.ndim() + 1 != ndim())
+                return false;
+
+            for (unsigned long d = 0; d < other.ndim(); ++d) {
+                if (other.m_shape[d] != m_shape[d < axis ? d : d + 1])
+                    return false;
+            }
+
+            return true;
+        }
+
+        // workspace slots of the axis reductions, gemm uses the first ones
+        static constexpr unsigned long __slot_lines = 8;
+        static constexpr unsigned long __slot_index = 9;
+        static constexpr unsigned long __slot_partials = 10;
+
+        // lines longer than this are worth splitting over the pool on their own
+        static constexpr unsigned long __parallel_line = 1ul << 16;
+
+        // up to this length a line is sorted with a branchless network
+        static constexpr unsigned long __network_line = 16;
+
+        // from this length on integer lines are radix sorted
+        static constexpr unsigned long __radix_line = 256;
+
+        using __is_radix_sortable = std::integral_constant<bool,
+                std::is_integral<T>::value && !std::is_same<T, bool>::value>;
+
+        unsigned long __axis(int axis) const {
+            if (m_type == value_t::scalar)
+                throw std::invalid_argument("axis out of bounds for a scalar");
+
+            auto n = static_cast<int>(ndim());
+
+            if (axis < -n || axis >= n)
+                throw std::invalid_argument("axis out of bounds");
+
+            return static_cast<unsigned long>(axis < 0 ? axis + n : axis);
+        }
+
+        // offsets of the first element of every 1-d line along axis
+        std::vector<unsigned long> __lines(unsigned long axis) const {
+            auto n = m_shape.at(axis);
+
+            if (n == 0)
+                return {};
+
+            std::vector<unsigned long> ret(__count() / n);
+            std::vector<unsigned long> index(ndim());
+
+            __lines(axis, ret.data(), index.data());
+
+            return ret;
+        }
+
+        // same as above into caller provided buffers, index needs ndim() entries
+        void __lines(unsigned long axis, unsigned long *ret, unsigned long *index) const {
+            auto n = m_shape.at(axis);
+            auto total = __count();
+
+            if (n == 0 || total == 0)
+                return;
+
+            std::fill(index, index + ndim(), 0ul);
+            auto offset = m_offset;
+
+            for (unsigned long l = 0; l < total / n; ++l) {
+                ret[l] = offset;
+
+                for (int d = (int) ndim() - 1; d >= 0; --d) {
+                    if (d == (int) axis) continue;
+
+                    offset += m_strides[d];
+
+                    if (++index[d] < m_shape[d])
+                        break;
+
+                    offset -= m_strides[d] * m_shape[d];
+                    index[d] = 0;
+                }
+            }
+        }
+
+        // lines per parallel_for chunk so a chunk holds a useful amount of work
+        static unsigned long __line_grain(unsigned long n) {
+            return std::max(1ul, kernel::grain / std::max(n, 1ul));
+        }
+
+        void __gather(unsigned long offset, unsigned long stride, unsigned long n, T *out) const {
+            for (unsigned long i = 0; i < n; ++i) {
+                out[i] = m_data[offset + i * stride];
+            }
+        }
+
+        // writes a line back, through to the base array when this is a view
+        void __scatter(const T *in, unsigned long offset, unsigned long stride, unsigned long n) {
+            for (unsigned long i = 0; i < n; ++i) {
+                m_data[offset + i * stride] = in[i];
+            }
+
+            if (m_base != nullptr) {
+                for (unsigned long i = 0; i < n; ++i) {
+                    m_base->m_data[offset + i * stride] = in[i];
+                }
+            }
+        }
+
+        // strict weak ordering that puts nan after every number
+        static bool __lt(const T &a, const T &b) {
+            return a < b || (b != b && a == a);
+        }
+
+        static void __sort_line(T *first, unsigned long n, T *, std::false_type) {
+            if (n <= __network_line)
+                __sort_network(first, n);
+            else
+                std::sort(first, first + n, &this_type::__lt);
+        }
+
+        // scratch holds n elements once n reaches __radix_line
+        static void __sort_line(T *first, unsigned long n, T *scratch, std::true_type) {
+            if (n <= __network_line)
+                __sort_network(first, n);
+            else if (n < __radix_line)
+                std::sort(first, first + n);
+            else
+                __radix_sort(first, n, scratch);
+        }
+
+        // batcher's odd-even merge sort. the compare-exchange pattern does not
+        // depend on the data, so it compiles to min/max style selects
+        static void __sort_network(T *v, unsigned long n) {
+            for (unsigned long p = 1; p < n; p <<= 1) {
+                for (unsigned long k = p; k >= 1; k >>= 1) {
+                    for (unsigned long j = k % p; j + k < n; j += 2 * k) {
+                        for (unsigned long i = 0; i < std::min(k, n - j - k); ++i) {
+                            if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                                auto &a = v[i + j];
+                                auto &b = v[i + j + k];
+                                auto exchange = __lt(b, a);
+                                T lo = exchange ? b : a;
+                                T hi = exchange ? a : b;
+                                a = lo;
+                                b = hi;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // lsd radix sort on 8 bit digits, digits shared by every key are skipped.
+        // the keys are sorted in place between first and scratch, an integer may
+        // be accessed through its unsigned counterpart.
+        static void __radix_sort(T *first, unsigned long n, T *scratch) {
+            using key_t = typename std::make_unsigned<T>::type;
+
+            const key_t flip = std::is_signed<T>::value ? key_t(key_t(1) << (sizeof(T) * 8 - 1)) : key_t(0);
+
+            auto keys = reinterpret_cast<key_t *>(first);
+            auto tmp = reinterpret_cast<key_t *>(scratch);
+
+            for (unsigned long i = 0; i < n; ++i) {
+                keys[i] = key_t(keys[i] ^ flip);
+            }
+
+            for (unsigned long shift = 0; shift < sizeof(T) * 8; shift += 8) {
+                unsigned long count[257] = {};
+
+                for (unsigned long i = 0; i < n; ++i) {
+                    ++count[((keys[i] >> shift) & 0xff) + 1];
+                }
+
+                if (count[((keys[0] >> shift) & 0xff) + 1] == n)
+                    continue;
+
+                for (unsigned long d = 0; d < 256; ++d) {
+                    count[d + 1] += count[d];
+                }
+
+                for (unsigned long i = 0; i < n; ++i) {
+                    tmp[count[(keys[i] >> shift) & 0xff]++] = keys[i];
+                }
+
+                std::swap(keys, tmp);
+            }
+
+            if (keys != reinterpret_cast<key_t *>(first))
+                std::copy(keys, keys + n, reinterpret_cast<key_t *>(first));
+
+            keys = reinterpret_cast<key_t *>(first);
+
+            for (unsigned long i = 0; i < n; ++i) {
+                keys[i] = key_t(keys[i] ^ flip);
+            }
+        }
+
+        // ranks by value, equal values by their index in the line
+        static bool __better(const std::pair<T, unsigned long> &a, const std::pair<T, unsigned long> &b,
+                             bool largest) {
+            if (largest ? __lt(b.first, a.first) : __lt(a.first, b.first)) return true;
+            if (__lt(a.first, b.first) || __lt(b.first, a.first)) return false;
+            return a.second < b.second;
+        }
+
+        // bounded heap holding the k best elements of line[lo, hi), worst on top
+        std::vector<std::pair<T, unsigned long>> __topk_line(unsigned long offset, unsigned long stride,
+                                                             unsigned long lo, unsigned long hi,
+                                                             unsigned long k, bool largest) const {
+            auto better = [largest](const std::pair<T, unsigned long> &a, const std::pair<T, unsigned long> &b) {
+                return __better(a, b, largest);
+            };
+
+            std::vector<std::pair<T, unsigned long>> heap;
+            heap.reserve(k);
+
+            unsigned long i = lo;
+
+            for (; i < hi && heap.size() < k; ++i) {
+                heap.push_back(std::make_pair(m_data[offset + i * stride], i));
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+
+            // indexes only grow, so an element equal to the worst kept one never
+            // replaces it and the scan only needs a single value comparison
+            for (; i < hi; ++i) {
+                const T &value = m_data[offset + i * stride];
+
+                if (largest ? __lt(heap.front().first, value) : __lt(value, heap.front().first)) {
+                    std::pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = std::make_pair(value, i);
+                    std::push_heap(heap.begin(), heap.end(), better);
+                }
+            }
+
+            std::sort(heap.begin(), heap.end(), better);
+
+            return heap;
+        }
+
+        static void __topk_select(std::vector<std::pair<T, unsigned long>> &candidates, unsigned long k,
+                                  bool largest) {
+            auto better = [largest](const std::pair<T, unsigned long> &a, const std::pair<T, unsigned long> &b) {
+                return __better(a, b, largest);
+            };
+
+            std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(), better);
+            candidates.resize(k);
+        }
+
+        static bool __close(const T &a, const T &b, double rtol, double atol, bool equal_nan) {
+            auto x = static_cast<double>(a);
+            auto y = static_cast<double>(b);
+
+            if (std::isnan(x) || std::isnan(y))
+                return equal_nan && std::isnan(x) && std::isnan(y);
+
+            if (x == y) // covers matching infinities
+                return true;
+
+            return std::fabs(x - y) <= atol + rtol * std::fabs(y);
+        }
+    };
+
+    //////////////////////////
+    // comparison functions //
+    //////////////////////////
+
+    template<class T>
+    bool array_equal(const array<T> &a, const array<T> &b) {
+        return a == b;
+    }
+
+    template<class T>
+    array<bool> isclose(const array<T> &a, const array<T> &b, double rtol = 1e-05, double atol = 1e-08,
+                        bool equal_nan = false) {
+        return a.isclose(b, rtol, atol, equal_nan);
+    }
+
+    template<class T>
+    bool allclose(const array<T> &a, const array<T> &b, double rtol = 1e-05, double atol = 1e-08,
+                  bool equal_nan = false) {
+        return a.allclose(b, rtol, atol, equal_nan);
+    }
+
+    /////////////////
+    // convolution //
+    /////////////////
+
+    enum class conv_mode : uint8_t {
+        full,
+        same,
+        valid,
+    };
+
+    enum class conv_method : uint8_t {
+        automatic,
+        direct,
+        im2col,
+        fft,
+    };
+
+    namespace kernel {
+        // floating point kernels from this many taps on go through the fft
+        constexpr unsigned long conv_fft_taps = 1024;
+
+        // most elements of the im2col scratch, larger outputs are done in slices
+        constexpr unsigned long conv_im2col_scratch = 1ul << 22;
+
+        // geometry of a correlation along one axis, positions are counted in the
+        // full output where the input is zero padded by span - 1 on both sides
+        struct conv_axis {
+            unsigned long n, k, span, start, out, stride, dilation;
+
+            conv_axis(unsigned long n, unsigned long k, conv_mode mode, unsigned long stride, unsigned long dilation)
+                    : n(n), k(k), span((k - 1) * dilation + 1), stride(stride), dilation(dilation) {
+                unsigned long length;
+
+                if (mode == conv_mode::full) {
+                    start = 0;
+                    length = n + span - 1;
+                } else if (mode == conv_mode::same) {
+                    start = (span - 1) / 2;
+                    length = n;
+                } else {
+                    if (span > n)
+                        throw std::invalid_argument("kernel is larger than the input in valid mode");
+
+                    start = span - 1;
+                    length = n - span + 1;
+                }
+
+                out = (length + stride - 1) / stride;
+            }
+
+            unsigned long padded() const { return n + 2 * (span - 1); }
+        };
+
+        template<class T>
+        std::vector<T> conv_pad(const buffer_t<T> &x, const conv_axis &rows, const conv_axis &cols) {
+            std::vector<T> ret(rows.padded() * cols.padded(), T());
+
+            for (unsigned long r = 0; r < rows.n; ++r) {
+                std::copy(x.begin() + r * cols.n, x.begin() + (r + 1) * cols.n,
+                          ret.begin() + (r + rows.span - 1) * cols.padded() + cols.span - 1);
+            }
+
+            return ret;
+        }
+
+        template<class T>
+        void conv_direct(const buffer_t<T> &x, const buffer_t<T> &w, const conv_axis &rows,
+                         const conv_axis &cols, buffer_t<T> &out) {
+            auto padded = conv_pad(x, rows, cols);
+
+            executor::instance().parallel_for(0, rows.out, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long oi = lo; oi < hi; ++oi) {
+                    auto dst = out.data() + oi * cols.out;
+                    auto row = rows.start + oi * rows.stride;
+
+                    for (unsigned long a = 0; a < rows.k; ++a) {
+                        auto src = padded.data() + (row + a * rows.dilation) * cols.padded() + cols.start;
+
+                        for (unsigned long b = 0; b < cols.k; ++b) {
+                            auto weight = w[a * cols.k + b];
+                            auto tap = src + b * cols.dilation;
+
+                            for (unsigned long oj = 0; oj < cols.out; ++oj) {
+                                dst[oj] += weight * tap[oj * cols.stride];
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        // lays every receptive field out as a column and multiplies the kernel with
+        // them. the columns are built for a slice of the output at a time, so the
+        // scratch stays below conv_im2col_scratch elements.
+        template<class T>
+        void conv_im2col(const buffer_t<T> &x, const buffer_t<T> &w, const conv_axis &rows,
+                         const conv_axis &cols, buffer_t<T> &out) {
+            auto padded = conv_pad(x, rows, cols);
+            auto taps = rows.k * cols.k;
+            auto positions = rows.out * cols.out;
+            auto slice = std::min(positions, std::max(1ul, conv_im2col_scratch / taps));
+            buffer_t<T> columns(taps * slice);
+
+            for (unsigned long first = 0; first < positions; first += slice) {
+                auto count = std::min(slice, positions - first);
+
+                executor::instance().parallel_for(0, taps, [&](unsigned long lo, unsigned long hi) {
+                    for (unsigned long t = lo; t < hi; ++t) {
+                        auto a = t / cols.k;
+                        auto b = t % cols.k;
+                        auto dst = columns.data() + t * count;
+
+                        for (unsigned long p = 0; p < count; ++p) {
+                            auto oi = (first + p) / cols.out;
+                            auto oj = (first + p) % cols.out;
+                            auto src = padded.data() + (rows.start + oi * rows.stride + a * rows.dilation) * cols.padded()
+                                       + cols.start + b * cols.dilation;
+
+                            dst[p] = src[oj * cols.stride];
+                        }
+                    }
+                });
+
+                gemm(1, count, taps, T(1), w.data(), taps, 1ul, columns.data(), count, 1ul,
+                     T(), out.data() + first, count, 1ul);
+            }
+        }
+
+        template<class T>
+        void conv_fft(const buffer_t<T> &x, const buffer_t<T> &w, const conv_axis &rows,
+                      const conv_axis &cols, buffer_t<T> &out) {
+            unsigned long fr = 1, fc = 1;
+
+            while (fr < rows.n + rows.span - 1) fr <<= 1;
+            while (fc < cols.n + cols.span - 1) fc <<= 1;
+
+            std::vector<std::complex<double>> signal(fr * fc), filter(fr * fc);
+
+            for (unsigned long r = 0; r < rows.n; ++r) {
+                for (unsigned long c = 0; c < cols.n; ++c) {
+                    signal[r * fc + c] = static_cast<double>(x[r * cols.n + c]);
+                }
+            }
+
+            // correlating is convolving with the mirrored, dilated kernel
+            for (unsigned long a = 0; a < rows.k; ++a) {
+                for (unsigned long b = 0; b < cols.k; ++b) {
+                    filter[(rows.span - 1 - a * rows.dilation) * fc + cols.span - 1 - b * cols.dilation] =
+                            static_cast<double>(w[a * cols.k + b]);
+                }
+            }
+
+            fft2(signal.data(), fr, fc, false);
+            fft2(filter.data(), fr, fc, false);
+
+            for (unsigned long i = 0; i < signal.size(); ++i) {
+                signal[i] *= filter[i];
+            }
+
+            fft2(signal.data(), fr, fc, true);
+
+            for (unsigned long oi = 0; oi < rows.out; ++oi) {
+                for (unsigned long oj = 0; oj < cols.out; ++oj) {
+                    auto val = signal[(rows.start + oi * rows.stride) * fc + cols.start + oj * cols.stride].real();
+
+                    out[oi * cols.out + oj] = static_cast<T>(std::is_integral<T>::value ? std::round(val) : val);
+                }
+            }
+        }
+
+        template<class T>
+        array<T> correlate(const array<T> &in, const array<T> &weights, conv_mode mode, unsigned long stride,
+                           unsigned long dilation, conv_method method, bool flip) {
+            if (!in.is_array() || !weights.is_array() || in.ndim() != weights.ndim() || in.ndim() > 2)
+                throw std::invalid_argument("convolution needs a 1-d or 2-d input and a kernel of the same rank");
+
+            if (stride == 0 || dilation == 0)
+                throw std::invalid_argument("stride and dilation must be at least 1");
+
+            auto two_d = in.ndim() == 2;
+            auto x = in.flatten().data();
+            auto w = weights.flatten().data();
+
+            if (w.empty() || x.empty())
+                throw std::invalid_argument("convolution of an empty array");
+
+            // convolving is correlating with the kernel mirrored along every axis
+            if (flip)
+                std::reverse(w.begin(), w.end());
+
+            conv_axis rows(two_d ? in.rows() : 1, two_d ? weights.rows() : 1, two_d ? mode : conv_mode::valid,
+                           two_d ? stride : 1, two_d ? dilation : 1);
+            conv_axis cols(in.shape().back(), weights.shape().back(), mode, stride, dilation);
+
+            // with a single channel im2col is a matrix vector product without any
+            // reuse, so below the fft threshold the direct loop is always faster
+            if (method == conv_method::automatic) {
+                if (w.size() >= conv_fft_taps && std::is_floating_point<T>::value && stride == 1)
+                    method = conv_method::fft;
+                else
+                    method = conv_method::direct;
+            }
+
+            buffer_t<T> out(rows.out * cols.out, T());
+
+            if (method == conv_method::direct)
+                conv_direct(x, w, rows, cols, out);
+            else if (method == conv_method::im2col)
+                conv_im2col(x, w, rows, cols, out);
+            else
+                conv_fft(x, w, rows, cols, out);
+
+            if (two_d)
+                return array<T>(std::move(out), {rows.out, cols.out});
+
+            return array<T>(std::move(out), {cols.out});
+        }
+    }
+
+    // sliding dot product of in with weights, like numpy.correlate and
+    // scipy.signal.correlate2d. same mode keeps the size of the input.
+    template<class T>
+    array<T> correlate(const array<T> &in, const array<T> &weights, conv_mode mode = conv_mode::valid,
+                       unsigned long stride = 1, unsigned long dilation = 1,
+                       conv_method method = conv_method::automatic) {
+        return kernel::correlate(in, weights, mode, stride, dilation, method, false);
+    }
+
+    template<class T>
+    array<T> convolve(const array<T> &in, const array<T> &weights, conv_mode mode = conv_mode::full,
+                      unsigned long stride = 1, unsigned long dilation = 1,
+                      conv_method method = conv_method::automatic) {
+        return kernel::correlate(in, weights, mode, stride, dilation, method, true);
+    }
+
+    ////////////////////////
+    // creation functions //
+    ////////////////////////
+
+    template<class T>
+    array<T> full(const std::deque<unsigned long> &shape, T value) {
+        return array<T>(shape, value);
+    }
+
+    template<class T>
+    array<T> zeros(const std::deque<unsigned long> &shape) {
+        return array<T>(shape, T(0));
+    }
+
+    template<class T>
+    array<T> ones(const std::deque<unsigned long> &shape) {
+        return array<T>(shape, T(1));
+    }
+
+    template<class T>
+    array<T> full_like(const array<T> &other, T value) {
+        return array<T>(other.shape(), value);
+    }
+
+    template<class T>
+    array<T> zeros_like(const array<T> &other) {
+        return array<T>(other.shape(), T(0));
+    }
+
+    template<class T>
+    array<T> ones_like(const array<T> &other) {
+        return array<T>(other.shape(), T(1));
+    }
+
+    // values from start up to (excluding) stop, like numpy.arange
+    template<class T>
+    array<T> arange(T start, T stop, T step = 1) {
+        if (step == T(0))
+            throw std::invalid_argument("step must not be zero");
+
+        auto span = std::ceil((static_cast<double>(stop) - start) / step);
+        auto count = span > 0 ? (unsigned long) span : 0ul;
+
+        buffer_t<T> data(count);
+
+        executor::instance().parallel_for(0, count, [&](unsigned long lo, unsigned long hi) {
+            for (unsigned long i = lo; i < hi; ++i) {
+                data[i] = static_cast<T>(start + i * step);
+            }
+        }, kernel::grain);
+
+        return array<T>(std::move(data), {count});
+    }
+
+    // num evenly spaced values over [start, stop], stop is left out without endpoint
+    template<class T>
+    array<T> linspace(T start, T stop, unsigned long num = 50, bool endpoint = true) {
+        auto div = endpoint ? num - 1 : num;
+        auto step = div > 0 ? (static_cast<double>(stop) - start) / div : 0.;
+
+        buffer_t<T> data(num);
+
+        executor::instance().parallel_for(0, num, [&](unsigned long lo, unsigned long hi) {
+            for (unsigned long i = lo; i < hi; ++i) {
+                data[i] = static_cast<T>(start + i * step);
+            }
+        }, kernel::grain);
+
+        if (endpoint && num > 1)
+            data.back() = stop;
+
+        return array<T>(std::move(data), {num});
+    }
+
+    // n x m matrix with ones on the k-th diagonal, k > 0 is above the main one
+    template<class T>
+    array<T> eye(unsigned long n, unsigned long m = 0, long k = 0) {
+        m = m == 0 ? n : m;
+
+        array<T> ret(std::deque<unsigned long>{n, m}, T(0));
+
+        for (unsigned long i = 0; i < n; ++i) {
+            auto j = (long) i + k;
+
+            if (j >= 0 && j < (long) m)
+                kernel::access::data(ret)[i * m + j] = T(1);
+        }
+
+        return ret;
+    }
+
+    namespace kernel {
+        // first element of a row major copy of a, flattening only when a is strided
+        template<class T>
+        const T *compact(const array<T> &a, array<T> &tmp) {
+            if (a.is_contiguous())
+                return a.data().data() + a.offset();
+
+            tmp = a.flatten();
+
+            return tmp.data().data();
+        }
+
+        // outer rows of out are the rows of every piece laid side by side. the
+        // output is split in equal chunks, so each worker first touches its own part.
+        template<class T>
+        void join(const std::vector<const T *> &pieces, const std::vector<unsigned long> &widths,
+                  unsigned long outer, buffer_t<T> &out) {
+            std::vector<unsigned long> starts(widths.size() + 1, 0);
+            std::partial_sum(widths.begin(), widths.end(), starts.begin() + 1);
+
+            auto row = starts.back();
+
+            executor::instance().parallel_for(0, outer * row, [&](unsigned long lo, unsigned long hi) {
+                while (lo < hi) {
+                    auto r = lo / row;
+                    auto c = lo % row;
+                    auto p = std::upper_bound(starts.begin(), starts.end(), c) - starts.begin() - 1;
+                    auto n = std::min(hi - lo, starts[p + 1] - c);
+                    auto src = pieces[p] + r * widths[p] + (c - starts[p]);
+
+                    std::copy(src, src + n, out.begin() + lo);
+                    lo += n;
+                }
+            }, kernel::grain);
+        }
+
+        template<class T>
+        std::vector<array<T>> split(const array<T> &a, const std::vector<unsigned long> &indices, unsigned long axis) {
+            auto shape = a.shape();
+
+            if (axis >= shape.size())
+                throw std::invalid_argument("axis out of bounds");
+
+            auto outer = std::accumulate(shape.begin(), shape.begin() + axis, 1ul, std::multiplies<unsigned long>());
+            auto inner = std::accumulate(shape.begin() + axis + 1, shape.end(), 1ul, std::multiplies<unsigned long>());
+            auto total = shape[axis];
+            auto row = total * inner;
+
+            array<T> tmp(T(0));
+            auto src = compact(a, tmp);
+
+            std::vector<array<T>> ret;
+            ret.reserve(indices.size() + 1);
+
+            for (unsigned long i = 0; i <= indices.size(); ++i) {
+                auto begin = std::min(i == 0 ? 0 : indices[i - 1], total);
+                auto end = std::max(begin, std::min(i == indices.size() ? total : indices[i], total));
+                auto width = (end - begin) * inner;
+
+                buffer_t<T> data(outer * width);
+
+                executor::instance().parallel_for(0, outer * width, [&](unsigned long lo, unsigned long hi) {
+                    while (lo < hi) {
+                        auto r = lo / width;
+                        auto c = lo % width;
+                        auto n = std::min(hi - lo, width - c);
+
+                        std::copy(src + r * row + begin * inner + c, src + r * row + begin * inner + c + n,
+                                  data.begin() + lo);
+                        lo += n;
+                    }
+                }, kernel::grain);
+
+                shape[axis] = end - begin;
+                ret.emplace_back(std::move(data), shape);
+            }
+
+            return ret;
+        }
+    }
+
+    ///////////////////////
+    // joining functions //
+    ///////////////////////
+
+    // joins arrays along an existing axis, all other dimensions have to match
+    template<class T>
+    array<T> concatenate(const std::vector<array<T>> &arrays, unsigned long axis = 0) {
+        if (arrays.empty())
+            throw std::invalid_argument("need at least one array to concatenate");
+
+        auto shape = arrays.front().shape();
+
+        if (axis >= shape.size())
+            throw std::invalid_argument("axis out of bounds");
+
+        auto outer = std::accumulate(shape.begin(), shape.begin() + axis, 1ul, std::multiplies<unsigned long>());
+        auto inner = std::accumulate(shape.begin() + axis + 1, shape.end(), 1ul, std::multiplies<unsigned long>());
+
+        std::vector<array<T>> tmp(arrays.size(), array<T>(T(0)));
+        std::vector<const T *> pieces;
+        std::vector<unsigned long> widths;
+
+        shape[axis] = 0;
+
+        for (unsigned long i = 0; i < arrays.size(); ++i) {
+            auto &other = arrays[i].shape();
+
+            if (other.size() != shape.size())
+                throw std::invalid_argument("all arrays must have the same number of dimensions");
+
+            for (unsigned long d = 0; d < shape.size(); ++d) {
+                if (d != axis && other[d] != shape[d])
+                    throw std::invalid_argument("array dimensions must match except along the axis");
+            }
+
+            shape[axis] += other[axis];
+            pieces.push_back(kernel::compact(arrays[i], tmp[i]));
+            widths.push_back(other[axis] * inner);
+        }
+
+        buffer_t<T> data(outer * shape[axis] * inner);
+        kernel::join(pieces, widths, outer, data);
+
+        return array<T>(std::move(data), shape);
+    }
+
+    // joins arrays of the same shape along a new axis
+    template<class T>
+    array<T> stack(const std::vector<array<T>> &arrays, unsigned long axis = 0) {
+        if (arrays.empty())
+            throw std::invalid_argument("need at least one array to stack");
+
+        auto shape = arrays.front().shape();
+
+        if (axis > shape.size())
+            throw std::invalid_argument("axis out of bounds");
+
+        auto outer = std::accumulate(shape.begin(), shape.begin() + axis, 1ul, std::multiplies<unsigned long>());
+        auto inner = std::accumulate(shape.begin() + axis, shape.end(), 1ul, std::multiplies<unsigned long>());
+
+        std::vector<array<T>> tmp(arrays.size(), array<T>(T(0)));
+        std::vector<const T *> pieces;
+
+        for (unsigned long i = 0; i < arrays.size(); ++i) {
+            if (arrays[i].shape() != shape)
+                throw std::invalid_argument("all input arrays must have the same shape");
+
+            pieces.push_back(kernel::compact(arrays[i], tmp[i]));
+        }
+
+        buffer_t<T> data(outer * arrays.size() * inner);
+        kernel::join(pieces, std::vector<unsigned long>(arrays.size(), inner), outer, data);
+
+        shape.insert(shape.begin() + axis, arrays.size());
+
+        return array<T>(std::move(data), shape);
+    }
+
+    // splits into equally sized pieces along axis
+    template<class T>
+    std::vector<array<T>> split(const array<T> &a, unsigned long sections, unsigned long axis = 0) {
+        if (axis >= a.ndim())
+            throw std::invalid_argument("axis out of bounds");
+
+        if (sections == 0 || a.shape()[axis] % sections != 0)
+            throw std::invalid_argument("array split does not result in an equal division");
+
+        std::vector<unsigned long> indices;
+        auto step = a.shape()[axis] / sections;
+
+        for (unsigned long i = 1; i < sections; ++i) {
+            indices.push_back(i * step);
+        }
+
+        return kernel::split(a, indices, axis);
+    }
+
+    // splits before every index along axis
+    template<class T>
+    std::vector<array<T>> split(const array<T> &a, const std::vector<unsigned long> &indices, unsigned long axis = 0) {
+        return kernel::split(a, indices, axis);
+    }
+
+    /////////////////
+    // aggregation //
+    /////////////////
+
+    enum class reduce_op : uint8_t {
+        sum,
+        mean,
+        min,
+        max,
+    };
+
+    namespace kernel {
+        template<class T>
+        unsigned long elements(const array<T> &a) {
+            auto &shape = a.shape();
+
+            return std::accumulate(shape.begin(), shape.end(), 1ul, std::multiplies<unsigned long>());
+        }
+
+        // splits n elements in at most one chunk per worker and gives every chunk
+        // its own copy of init, so no bin is ever written by two threads
+        template<class B, typename callback>
+        std::vector<B> private_bins(unsigned long n, const B &init, callback clb, unsigned long grain = kernel::grain) {
+            auto &ex = executor::instance();
+            auto chunks = std::max(1ul, std::min(ex.size(), n / grain));
+
+            std::vector<B> local(chunks, init);
+
+            ex.parallel_for(0, chunks, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long c = lo; c < hi; ++c) {
+                    clb(n * c / chunks, n * (c + 1) / chunks, local[c]);
+                }
+            });
+
+            return local;
+        }
+
+        // folds all private bins into the first one, the bins are split over the pool
+        template<class V, typename callback>
+        void merge_bins(std::vector<std::vector<V>> &local, callback clb) {
+            executor::instance().parallel_for(0, local.front().size(), [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long c = 1; c < local.size(); ++c) {
+                    for (unsigned long b = lo; b < hi; ++b) {
+                        local[0][b] = clb(local[0][b], local[c][b]);
+                    }
+                }
+            }, 1ul << 12);
+        }
+
+        // smallest and largest value of data, nan is skipped
+        template<class T>
+        std::pair<T, T> minmax(const T *data, unsigned long n) {
+            auto local = private_bins(n, std::make_pair(highest<T>(), lowest<T>()),
+                                      [&](unsigned long lo, unsigned long hi, std::pair<T, T> &bin) {
+                                          for (unsigned long i = lo; i < hi; ++i) {
+                                              if (data[i] < bin.first) bin.first = data[i];
+                                              if (data[i] > bin.second) bin.second = data[i];
+                                          }
+                                      });
+
+            auto ret = local.front();
+
+            for (auto &bin : local) {
+                ret.first = std::min(ret.first, bin.first);
+                ret.second = std::max(ret.second, bin.second);
+            }
+
+            return ret;
+        }
+
+        // nan sorts last and all nans count as one value
+        template<class T>
+        bool unique_lt(T a, T b) {
+            return a < b || (a == a && b != b);
+        }
+
+        template<class T>
+        bool unique_eq(T a, T b) {
+            return a == b || (a != a && b != b);
+        }
+
+        template<class T>
+        using runs_t = std::vector<std::pair<T, unsigned long>>;
+
+        template<class T>
+        runs_t<T> merge_runs(const runs_t<T> &a, const runs_t<T> &b) {
+            runs_t<T> ret;
+            ret.reserve(a.size() + b.size());
+
+            auto i = a.begin();
+            auto j = b.begin();
+
+            while (i != a.end() || j != b.end()) {
+                if (j == b.end() || (i != a.end() && unique_lt(i->first, j->first))) {
+                    ret.push_back(*i++);
+                } else if (i == a.end() || unique_lt(j->first, i->first)) {
+                    ret.push_back(*j++);
+                } else {
+                    ret.emplace_back(i->first, i->second + j->second);
+                    ++i, ++j;
+                }
+            }
+
+            return ret;
+        }
+
+        // sorted distinct values with their counts: every chunk sorts and
+        // run-length encodes its own copy, the runs are merged afterwards
+        template<class T>
+        runs_t<T> unique(const array<T> &a) {
+            array<T> tmp(T(0));
+            auto data = compact(a, tmp);
+
+            auto local = private_bins(elements(a), runs_t<T>(), [&](unsigned long lo, unsigned long hi, runs_t<T> &runs) {
+                std::vector<T> values(data + lo, data + hi);
+                std::sort(values.begin(), values.end(), unique_lt<T>);
+
+                for (auto &val : values) {
+                    if (!runs.empty() && unique_eq(runs.back().first, val))
+                        ++runs.back().second;
+                    else
+                        runs.emplace_back(val, 1ul);
+                }
+            });
+
+            auto ret = std::move(local.front());
+
+            for (unsigned long c = 1; c < local.size(); ++c) {
+                ret = merge_runs(ret, local[c]);
+            }
+
+            return ret;
+        }
+
+        template<class T>
+        struct group_t {
+            T value;
+            unsigned long count;
+        };
+
+        template<class T>
+        group_t<T> group_init(reduce_op op) {
+            if (op == reduce_op::min)
+                return {highest<T>(), 0};
+
+            if (op == reduce_op::max)
+                return {lowest<T>(), 0};
+
+            return {T(0), 0};
+        }
+
+        // integer groups are reported in double, so their means are not truncated
+        template<class T>
+        using group_value_t = typename std::conditional<std::is_integral<T>::value, double, T>::type;
+
+        // widest key range reduced into dense tables. every chunk keeps its own
+        // table, so it is bounded to stay in cache whatever the number of keys.
+        constexpr unsigned long group_dense_width = 1ul << 14;
+
+        // hashing of the sparse path, every nan lands in the same group
+        template<class K>
+        struct group_hash {
+            std::size_t operator()(K key) const {
+                return key != key ? 0 : std::hash<K>()(key);
+            }
+        };
+
+        template<class K>
+        struct group_eq {
+            bool operator()(K a, K b) const {
+                return unique_eq(a, b);
+            }
+        };
+
+        template<class T>
+        T group_fold(reduce_op op, T a, T b) {
+            if (op == reduce_op::min)
+                return b < a ? b : a;
+
+            if (op == reduce_op::max)
+                return b > a ? b : a;
+
+            return a + b;
+        }
+
+        template<class T>
+        group_value_t<T> group_value(reduce_op op, const group_t<T> &group) {
+            using R = group_value_t<T>;
+
+            return op == reduce_op::mean ? static_cast<R>(group.value) / static_cast<R>(group.count)
+                                         : static_cast<R>(group.value);
+        }
+
+        // keys spanning a small range are reduced into dense per chunk tables,
+        // anything else goes through per chunk hash maps
+        template<class K, class T>
+        std::pair<array<K>, array<group_value_t<T>>> group_by(const array<K> &keys, const array<T> &values,
+                                                              reduce_op op) {
+            auto n = elements(keys);
+
+            if (n != elements(values))
+                throw std::invalid_argument("keys and values must have the same size");
+
+            array<K> key_tmp(K(0));
+            array<T> value_tmp(T(0));
+            auto k = compact(keys, key_tmp);
+            auto v = compact(values, value_tmp);
+
+            buffer_t<K> out_keys;
+            buffer_t<group_value_t<T>> out_values;
+
+            auto range = n == 0 || !std::is_integral<K>::value ? std::make_pair(K(0), K(0)) : minmax(k, n);
+            // max - min taken modulo 2^64 is exact for any integer key type
+            auto base = static_cast<unsigned long>(range.first);
+            auto span = static_cast<unsigned long>(range.second) - base;
+
+            if (n != 0 && std::is_integral<K>::value && span < std::min(std::max(n, 1ul << 10), group_dense_width)) {
+                auto width = span + 1;
+                auto local = private_bins(n, std::vector<group_t<T>>(width, group_init<T>(op)),
+                                          [&](unsigned long lo, unsigned long hi, std::vector<group_t<T>> &bins) {
+                                              for (unsigned long i = lo; i < hi; ++i) {
+                                                  auto &bin = bins[static_cast<unsigned long>(k[i]) - base];
+                                                  bin.value = group_fold(op, bin.value, v[i]);
+                                                  ++bin.count;
+                                              }
+                                          });
+
+                merge_bins(local, [&](const group_t<T> &a, const group_t<T> &b) {
+                    return group_t<T>{group_fold(op, a.value, b.value), a.count + b.count};
+                });
+
+                for (unsigned long b = 0; b < width; ++b) {
+                    if (local[0][b].count == 0)
+                        continue;
+
+                    out_keys.push_back(static_cast<K>(range.first + b));
+                    out_values.push_back(group_value(op, local[0][b]));
+                }
+            } else {
+                using map_t = std::unordered_map<K, group_t<T>, group_hash<K>, group_eq<K>>;
+
+                auto local = private_bins(n, map_t(), [&](unsigned long lo, unsigned long hi, map_t &bins) {
+                    for (unsigned long i = lo; i < hi; ++i) {
+                        auto it = bins.emplace(k[i], group_init<T>(op)).first;
+                        it->second.value = group_fold(op, it->second.value, v[i]);
+                        ++it->second.count;
+                    }
+                });
+
+                auto &ret = local.front();
+
+                for (unsigned long c = 1; c < local.size(); ++c) {
+                    for (auto &group : local[c]) {
+                        auto it = ret.emplace(group.first, group_init<T>(op)).first;
+                        it->second.value = group_fold(op, it->second.value, group.second.value);
+                        it->second.count += group.second.count;
+                    }
+                }
+
+                std::vector<std::pair<K, group_t<T>>> groups(ret.begin(), ret.end());
+                std::sort(groups.begin(), groups.end(),
+                          [](const std::pair<K, group_t<T>> &a, const std::pair<K, group_t<T>> &b) {
+                              return unique_lt(a.first, b.first);
+                          });
+
+                for (auto &group : groups) {
+                    out_keys.push_back(group.first);
+                    out_values.push_back(group_value(op, group.second));
+                }
+            }
+
+            auto size = out_keys.size();
+
+            return std::make_pair(array<K>(std::move(out_keys), {size}),
+                                  array<group_value_t<T>>(std::move(out_values), {size}));
+        }
+    }
+
+    // counts per bin over [lo, hi], the last bin includes hi. values outside
+    // the range and nan are left out. returns the counts and the bin edges.
+    template<class T>
+    std::pair<array<unsigned long>, array<double>> histogram(const array<T> &a, unsigned long bins, double lo,
+                                                             double hi) {
+        if (bins == 0)
+            throw std::invalid_argument("number of bins must be positive");
+
+        if (!(lo <= hi))
+            throw std::invalid_argument("max must be larger than min in range parameter");
+
+        if (lo == hi) {
+            lo -= 0.5;
+            hi += 0.5;
+        }
+
+        buffer_t<double> edges(bins + 1);
+
+        for (unsigned long i = 0; i <= bins; ++i) {
+            edges[i] = lo + (hi - lo) * i / bins;
+        }
+
+        edges.back() = hi;
+
+        array<T> tmp(T(0));
+        auto data = kernel::compact(a, tmp);
+        auto scale = bins / (hi - lo);
+
+        auto local = kernel::private_bins(kernel::elements(a), std::vector<unsigned long>(bins, 0),
+                                          [&](unsigned long begin, unsigned long end, std::vector<unsigned long> &counts) {
+                                              for (unsigned long i = begin; i < end; ++i) {
+                                                  double val = data[i];
+
+                                                  if (!(val >= lo && val <= hi))
+                                                      continue;
+
+                                                  auto b = std::min(bins - 1, (unsigned long) ((val - lo) * scale));
+
+                                                  // rounding of scale can put a value next to its bin
+                                                  if (val < edges[b])
+                                                      --b;
+                                                  else if (b + 1 < bins && val >= edges[b + 1])
+                                                      ++b;
+
+                                                  ++counts[b];
+                                              }
+                                          }, std::max(kernel::grain, bins));
+
+        kernel::merge_bins(local, std::plus<unsigned long>());
+
+        buffer_t<unsigned long> counts(local.front().begin(), local.front().end());
+
+        return std::make_pair(array<unsigned long>(std::move(counts), {bins}),
+                              array<double>(std::move(edges), {bins + 1}));
+    }
+
+    // uniform bins over the range of a
+    template<class T>
+    std::pair<array<unsigned long>, array<double>> histogram(const array<T> &a, unsigned long bins = 10) {
+        array<T> tmp(T(0));
+        auto n = kernel::elements(a);
+        auto range = n == 0 ? std::make_pair(T(0), T(1)) : kernel::minmax(kernel::compact(a, tmp), n);
+
+        if (range.first > range.second)
+            range = std::make_pair(T(0), T(1));
+
+        return histogram(a, bins, static_cast<double>(range.first), static_cast<double>(range.second));
+    }
+
+    // counts per bin given by increasing edges, the last bin includes its right edge
+    template<class T>
+    std::pair<array<unsigned long>, array<double>> histogram(const array<T> &a, const array<double> &edges) {
+        array<double> edge_tmp(0.);
+        auto n_edges = kernel::elements(edges);
+        auto e = kernel::compact(edges, edge_tmp);
+
+        if (edges.ndim() != 1 || n_edges < 2)
+            throw std::invalid_argument("bins must be a 1-d array with at least two edges");
+
+        if (!std::is_sorted(e, e + n_edges))
+            throw std::invalid_argument("bins must increase monotonically");
+
+        auto bins = n_edges - 1;
+
+        array<T> tmp(T(0));
+        auto data = kernel::compact(a, tmp);
+
+        auto local = kernel::private_bins(kernel::elements(a), std::vector<unsigned long>(bins, 0),
+                                          [&](unsigned long begin, unsigned long end, std::vector<unsigned long> &counts) {
+                                              for (unsigned long i = begin; i < end; ++i) {
+                                                  double val = data[i];
+
+                                                  if (!(val >= e[0] && val <= e[bins]))
+                                                      continue;
+
+                                                  auto b = std::upper_bound(e, e + n_edges, val) - e - 1;
+                                                  ++counts[std::min(bins - 1, (unsigned long) b)];
+                                              }
+                                          }, std::max(kernel::grain, bins));
+
+        kernel::merge_bins(local, std::plus<unsigned long>());
+
+        buffer_t<unsigned long> counts(local.front().begin(), local.front().end());
+
+        return std::make_pair(array<unsigned long>(std::move(counts), {bins}),
+                              array<double>(buffer_t<double>(e, e + n_edges), {n_edges}));
+    }
+
+    // number of occurrences of every non-negative integer up to the largest one in a
+    template<class T>
+    array<unsigned long> bincount(const array<T> &a, unsigned long minlength = 0) {
+        static_assert(std::is_integral<T>::value, "bincount requires an integral element type");
+
+        array<T> tmp(T(0));
+        auto n = kernel::elements(a);
+        auto data = kernel::compact(a, tmp);
+        auto range = n == 0 ? std::make_pair(T(0), T(0)) : kernel::minmax(data, n);
+
+        if (range.first < 0)
+            throw std::invalid_argument("bincount requires non-negative values");
+
+        auto bins = std::max(minlength, n == 0 ? 0ul : static_cast<unsigned long>(range.second) + 1);
+
+        auto local = kernel::private_bins(n, std::vector<unsigned long>(bins, 0),
+                                          [&](unsigned long lo, unsigned long hi, std::vector<unsigned long> &counts) {
+                                              for (unsigned long i = lo; i < hi; ++i) {
+                                                  ++counts[data[i]];
+                                              }
+                                          }, std::max(kernel::grain, bins));
+
+        if (bins != 0)
+            kernel::merge_bins(local, std::plus<unsigned long>());
+
+        buffer_t<unsigned long> counts(local.front().begin(), local.front().end());
+
+        return array<unsigned long>(std::move(counts), {bins});
+    }
+
+    // sum of weights per non-negative integer in a
+    template<class T, class W>
+    array<W> bincount(const array<T> &a, const array<W> &weights, unsigned long minlength = 0) {
+        static_assert(std::is_integral<T>::value, "bincount requires an integral element type");
+
+        array<T> tmp(T(0));
+        array<W> weight_tmp(W(0));
+        auto n = kernel::elements(a);
+
+        if (n != kernel::elements(weights))
+            throw std::invalid_argument("weights must have the same size as the input");
+
+        auto data = kernel::compact(a, tmp);
+        auto w = kernel::compact(weights, weight_tmp);
+        auto range = n == 0 ? std::make_pair(T(0), T(0)) : kernel::minmax(data, n);
+
+        if (range.first < 0)
+            throw std::invalid_argument("bincount requires non-negative values");
+
+        auto bins = std::max(minlength, n == 0 ? 0ul : static_cast<unsigned long>(range.second) + 1);
+
+        auto local = kernel::private_bins(n, std::vector<W>(bins, W(0)),
+                                          [&](unsigned long lo, unsigned long hi, std::vector<W> &sums) {
+                                              for (unsigned long i = lo; i < hi; ++i) {
+                                                  sums[data[i]] += w[i];
+                                              }
+                                          }, std::max(kernel::grain, bins));
+
+        if (bins != 0)
+            kernel::merge_bins(local, std::plus<W>());
+
+        buffer_t<W> sums(local.front().begin(), local.front().end());
+
+        return array<W>(std::move(sums), {bins});
+    }
+
+    // sorted distinct values of a
+    template<class T>
+    array<T> unique(const array<T> &a) {
+        auto runs = kernel::unique(a);
+
+        buffer_t<T> values(runs.size());
+
+        for (unsigned long i = 0; i < runs.size(); ++i) {
+            values[i] = runs[i].first;
+        }
+
+        return array<T>(std::move(values), {runs.size()});
+    }
+
+    // sorted distinct values of a and how often each of them occurs
+    template<class T>
+    std::pair<array<T>, array<unsigned long>> unique_counts(const array<T> &a) {
+        auto runs = kernel::unique(a);
+
+        buffer_t<T> values(runs.size());
+        buffer_t<unsigned long> counts(runs.size());
+
+        for (unsigned long i = 0; i < runs.size(); ++i) {
+            values[i] = runs[i].first;
+            counts[i] = runs[i].second;
+        }
+
+        return std::make_pair(array<T>(std::move(values), {runs.size()}),
+                              array<unsigned long>(std::move(counts), {runs.size()}));
+    }
+
+    // reduces values sharing the same key, like a sql group by. returns the
+    // sorted distinct keys and the reduction of every group. all nan keys form
+    // one group, sorted last. integer values are reduced in their own type and
+    // reported in double, so means are not truncated.
+    template<class K, class T>
+    std::pair<array<K>, array<kernel::group_value_t<T>>> group_by(const array<K> &keys, const array<T> &values,
+                                                                  reduce_op op = reduce_op::sum) {
+        return kernel::group_by(keys, values, op);
+    }
+
+    ///////////////////////////
+    // elementwise functions //
+    ///////////////////////////
+
+    namespace kernel {
+        // out[i] = clb(a[i], b[i]) for operands of the same shape, the same element
+        // may be passed as a and out. nothing is allocated.
+        template<class T, typename callback>
+        array<T> &elementwise(const array<T> &a, const array<T> &b, array<T> &out, callback clb) {
+            if (out.base() != nullptr)
+                throw std::invalid_argument("output array must not be a view");
+
+            if (a.shape() != b.shape() || a.shape() != out.shape())
+                throw std::invalid_argument("operands could not be broadcast together");
+
+            if (!a.is_contiguous() || !b.is_contiguous() || !out.is_contiguous())
+                throw std::invalid_argument("elementwise operands must be contiguous");
+
+            auto x = a.data().data() + a.offset();
+            auto y = b.data().data() + b.offset();
+            auto dst = kernel::access::data(out).data() + out.offset();
+
+            executor::instance().parallel_for(0, elements(out), [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long i = lo; i < hi; ++i) {
+                    dst[i] = clb(x[i], y[i]);
+                }
+            }, kernel::grain);
+
+            return out;
+        }
+
+        template<class T, typename callback>
+        array<T> &elementwise(const array<T> &a, T b, array<T> &out, callback clb) {
+            if (out.base() != nullptr)
+                throw std::invalid_argument("output array must not be a view");
+
+            if (a.shape() != out.shape())
+                throw std::invalid_argument("operands could not be broadcast together");
+
+            if (!a.is_contiguous() || !out.is_contiguous())
+                throw std::invalid_argument("elementwise operands must be contiguous");
+
+            auto x = a.data().data() + a.offset();
+            auto dst = kernel::access::data(out).data() + out.offset();
+
+            executor::instance().parallel_for(0, elements(out), [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long i = lo; i < hi; ++i) {
+                    dst[i] = clb(x[i], b);
+                }
+            }, kernel::grain);
+
+            return out;
+        }
+    }
+
+    // a op b written into out, which must have the shape of a. out may be a
+    // itself, so a loop can reuse its buffers instead of creating temporaries.
+    template<class T>
+    array<T> &add(const array<T> &a, const array<T> &b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::plus<T>());
+    }
+
+    template<class T>
+    array<T> &add(const array<T> &a, T b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::plus<T>());
+    }
+
+    template<class T>
+    array<T> &subtract(const array<T> &a, const array<T> &b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::minus<T>());
+    }
+
+    template<class T>
+    array<T> &subtract(const array<T> &a, T b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::minus<T>());
+    }
+
+    template<class T>
+    array<T> &multiply(const array<T> &a, const array<T> &b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::multiplies<T>());
+    }
+
+    template<class T>
+    array<T> &multiply(const array<T> &a, T b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::multiplies<T>());
+    }
+
+    template<class T>
+    array<T> &divide(const array<T> &a, const array<T> &b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::divides<T>());
+    }
+
+    template<class T>
+    array<T> &divide(const array<T> &a, T b, array<T> &out) {
+        return kernel::elementwise(a, b, out, std::divides<T>());
+    }
 }
 
 #endif //ARRAY_ARRAY_HPP
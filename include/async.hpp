@@ -0,0 +1,292 @@
+/*
+MIT License
+
+Copyright (c) 2017 Jamie Cheng
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ARRAY_ASYNC_HPP
+#define ARRAY_ASYNC_HPP
+
+#include "array.hpp"
+
+namespace nd {
+    namespace kernel {
+        // completion state shared by a future and the task producing it
+        struct async_state {
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool done = false;
+            std::exception_ptr error;
+            std::vector<std::function<void()>> continuations;
+
+            // runs clb once the state is done, right away when it already is
+            void then(std::function<void()> clb) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    if (!done) {
+                        continuations.push_back(std::move(clb));
+                        return;
+                    }
+                }
+
+                clb();
+            }
+
+            void finish(std::exception_ptr e) {
+                std::vector<std::function<void()>> ready;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    error = e;
+                    done = true;
+                    ready.swap(continuations);
+                }
+
+                cv.notify_all();
+
+                for (auto &clb : ready) {
+                    clb();
+                }
+            }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return done; });
+            }
+        };
+
+        template<class R>
+        struct async_value : async_state {
+            std::unique_ptr<R> value;
+
+            template<typename callback>
+            void run(callback clb) { value.reset(new R(clb())); }
+        };
+
+        template<>
+        struct async_value<void> : async_state {
+            template<typename callback>
+            void run(callback clb) { clb(); }
+        };
+    }
+
+    template<class R>
+    class future;
+
+    namespace kernel {
+        struct async_access {
+            template<class R>
+            static std::shared_ptr<async_state> state(const future<R> &f) { return f.m_state; }
+        };
+    }
+
+    template<class R, typename callback>
+    future<R> __launch(executor &ex, std::vector<std::shared_ptr<kernel::async_state>> deps, callback clb);
+
+    // handle on the result of an asynchronous operation. copies share the result.
+    template<class R>
+    class future {
+    public:
+        future() = default;
+
+        bool valid() const { return m_state != nullptr; }
+
+        bool ready() const {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            return m_state->done;
+        }
+
+        void wait() const { m_state->wait(); }
+
+        // blocks until the result is there, rethrows the error of the operation
+        const R &get() const {
+            wait();
+
+            if (m_state->error)
+                std::rethrow_exception(m_state->error);
+
+            return *m_state->value;
+        }
+
+    private:
+        friend struct kernel::async_access;
+
+        template<class U, typename callback>
+        friend future<U> __launch(executor &, std::vector<std::shared_ptr<kernel::async_state>>, callback);
+
+        explicit future(std::shared_ptr<kernel::async_value<R>> state) : m_state(std::move(state)) {}
+
+        std::shared_ptr<kernel::async_value<R>> m_state;
+    };
+
+    template<>
+    class future<void> {
+    public:
+        future() = default;
+
+        bool valid() const { return m_state != nullptr; }
+
+        bool ready() const {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            return m_state->done;
+        }
+
+        void wait() const { m_state->wait(); }
+
+        void get() const {
+            wait();
+
+            if (m_state->error)
+                std::rethrow_exception(m_state->error);
+        }
+
+    private:
+        friend struct kernel::async_access;
+
+        template<class U, typename callback>
+        friend future<U> __launch(executor &, std::vector<std::shared_ptr<kernel::async_state>>, callback);
+
+        explicit future(std::shared_ptr<kernel::async_value<void>> state) : m_state(std::move(state)) {}
+
+        std::shared_ptr<kernel::async_value<void>> m_state;
+    };
+
+    // queues clb on the executor once every state in deps is done
+    template<class R, typename callback>
+    future<R> __launch(executor &ex, std::vector<std::shared_ptr<kernel::async_state>> deps, callback clb) {
+        auto state = std::make_shared<kernel::async_value<R>>();
+        auto pending = std::make_shared<std::atomic<unsigned long>>(deps.size() + 1);
+
+        auto start = [&ex, state, clb] {
+            ex.submit([state, clb] {
+                std::exception_ptr error;
+
+                try {
+                    state->run(clb);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                state->finish(error);
+            });
+        };
+
+        for (auto &dep : deps) {
+            dep->then([pending, start] {
+                if (--*pending == 0) start();
+            });
+        }
+
+        if (--*pending == 0)
+            start();
+
+        return future<R>(state);
+    }
+
+    template<class R>
+    future<R> make_ready_future(R value) {
+        return __launch<R>(executor::instance(), {}, [value] { return value; });
+    }
+
+    // runs clb on the executor with the results of deps once they are all ready.
+    // an error in one of the dependencies is rethrown by the returned future.
+    template<typename callback, class... D>
+    auto async(callback clb, const future<D> &... deps) -> future<decltype(clb(deps.get()...))> {
+        using result_t = decltype(clb(deps.get()...));
+
+        return __launch<result_t>(executor::instance(), {kernel::async_access::state(deps)...}, [clb, deps...] {
+            return clb(deps.get()...);
+        });
+    }
+
+    template<class T>
+    future<array<T>> async_dot(const future<array<T>> &a, const future<array<T>> &b) {
+        return async([](const array<T> &x, const array<T> &y) { return x.dot(y); }, a, b);
+    }
+
+    template<class T>
+    future<T> async_sum(const future<array<T>> &a) {
+        return async([](const array<T> &x) { return x.sum(); }, a);
+    }
+
+    template<class T>
+    future<array<T>> async_sum(const future<array<T>> &a, int axis) {
+        return async([axis](const array<T> &x) { return x.sum(axis); }, a);
+    }
+
+    template<class T>
+    future<std::string> async_dump(const future<array<T>> &a) {
+        return async([](const array<T> &x) { return x.dump(); }, a);
+    }
+
+    // ordered queue of operations: every operation enqueued on a stream starts
+    // after the previous one finished. separate streams run concurrently.
+    class stream {
+    public:
+        explicit stream(executor &ex = executor::instance()) : m_executor(ex) {}
+
+        stream(const stream &) = delete;
+
+        stream &operator=(const stream &) = delete;
+
+        ~stream() { synchronize(); }
+
+        template<typename callback, class... D>
+        auto enqueue(callback clb, const future<D> &... deps) -> future<decltype(clb(deps.get()...))> {
+            using result_t = decltype(clb(deps.get()...));
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<std::shared_ptr<kernel::async_state>> after = {kernel::async_access::state(deps)..., m_last};
+
+            if (!m_last)
+                after.pop_back();
+
+            auto ret = __launch<result_t>(m_executor, after, [clb, deps...] {
+                return clb(deps.get()...);
+            });
+
+            m_last = kernel::async_access::state(ret);
+
+            return ret;
+        }
+
+        // blocks until everything enqueued so far has finished
+        void synchronize() {
+            std::shared_ptr<kernel::async_state> last;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                last = m_last;
+            }
+
+            if (last)
+                last->wait();
+        }
+
+    private:
+        executor &m_executor;
+        std::mutex m_mutex;
+        std::shared_ptr<kernel::async_state> m_last;
+    };
+}
+
+#endif //ARRAY_ASYNC_HPP
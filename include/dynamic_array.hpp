@@ -0,0 +1,406 @@
+/*
+MIT License
+
+Copyright (c) 2017 Jamie Cheng
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ARRAY_DYNAMIC_ARRAY_HPP
+#define ARRAY_DYNAMIC_ARRAY_HPP
+
+#include <cstdint>
+
+#include "array.hpp"
+
+namespace nd {
+    enum class dtype_t : uint8_t {
+        bool_,
+        int8,
+        int16,
+        int32,
+        int64,
+        uint8,
+        uint16,
+        uint32,
+        uint64,
+        float32,
+        float64,
+    };
+
+    template<class T>
+    struct dtype_of;
+
+    template<> struct dtype_of<bool> { static constexpr dtype_t value = dtype_t::bool_; };
+    template<> struct dtype_of<int8_t> { static constexpr dtype_t value = dtype_t::int8; };
+    template<> struct dtype_of<int16_t> { static constexpr dtype_t value = dtype_t::int16; };
+    template<> struct dtype_of<int32_t> { static constexpr dtype_t value = dtype_t::int32; };
+    template<> struct dtype_of<int64_t> { static constexpr dtype_t value = dtype_t::int64; };
+    template<> struct dtype_of<uint8_t> { static constexpr dtype_t value = dtype_t::uint8; };
+    template<> struct dtype_of<uint16_t> { static constexpr dtype_t value = dtype_t::uint16; };
+    template<> struct dtype_of<uint32_t> { static constexpr dtype_t value = dtype_t::uint32; };
+    template<> struct dtype_of<uint64_t> { static constexpr dtype_t value = dtype_t::uint64; };
+    template<> struct dtype_of<float> { static constexpr dtype_t value = dtype_t::float32; };
+    template<> struct dtype_of<double> { static constexpr dtype_t value = dtype_t::float64; };
+
+    inline unsigned long itemsize(dtype_t dtype) {
+        static const unsigned long sizes[] = {1, 1, 2, 4, 8, 1, 2, 4, 8, 4, 8};
+        return sizes[static_cast<int>(dtype)];
+    }
+
+    inline const char *dtype_name(dtype_t dtype) {
+        static const char *names[] = {"bool", "int8", "int16", "int32", "int64", "uint8", "uint16", "uint32",
+                                      "uint64", "float32", "float64"};
+        return names[static_cast<int>(dtype)];
+    }
+
+    inline bool is_signed(dtype_t dtype) { return dtype >= dtype_t::int8 && dtype <= dtype_t::int64; }
+
+    inline bool is_unsigned(dtype_t dtype) { return dtype >= dtype_t::uint8 && dtype <= dtype_t::uint64; }
+
+    inline bool is_floating(dtype_t dtype) { return dtype >= dtype_t::float32; }
+
+    // smallest dtype both a and b can be converted to, following numpy.promote_types
+    inline dtype_t promote_types(dtype_t a, dtype_t b) {
+        if (a == b || b == dtype_t::bool_) return a;
+        if (a == dtype_t::bool_) return b;
+
+        auto sa = itemsize(a), sb = itemsize(b);
+
+        if (is_floating(a) || is_floating(b)) {
+            if (is_floating(a) && is_floating(b)) return sa > sb ? a : b;
+
+            auto f = is_floating(a) ? a : b;
+            auto i = is_floating(a) ? b : a;
+
+            return itemsize(f) > itemsize(i) ? f : dtype_t::float64;
+        }
+
+        if (is_signed(a) == is_signed(b)) return sa > sb ? a : b;
+
+        auto u = is_unsigned(a) ? a : b;
+        auto s = is_unsigned(a) ? b : a;
+
+        if (itemsize(s) > itemsize(u)) return s;
+
+        // the signed type needs twice the width of the unsigned one
+        switch (itemsize(u)) {
+            case 1: return dtype_t::int16;
+            case 2: return dtype_t::int32;
+            case 4: return dtype_t::int64;
+            default: return dtype_t::float64;
+        }
+    }
+
+    enum class binary_op : uint8_t {
+        add,
+        subtract,
+        multiply,
+        divide,
+        maximum,
+        minimum,
+        equal,
+        less,
+        greater,
+    };
+
+    class dynamic_array;
+
+    namespace kernel {
+        // one entry per dtype, in the order of dtype_t. Kernel<T>::run is looked up
+        // once per call and the loop inside it is fully typed.
+        template<template<class> class Kernel>
+        struct dtype_table {
+            using function = decltype(&Kernel<bool>::run);
+
+            static function at(dtype_t dtype) {
+                static const function table[] = {
+                        &Kernel<bool>::run, &Kernel<int8_t>::run, &Kernel<int16_t>::run, &Kernel<int32_t>::run,
+                        &Kernel<int64_t>::run, &Kernel<uint8_t>::run, &Kernel<uint16_t>::run,
+                        &Kernel<uint32_t>::run, &Kernel<uint64_t>::run, &Kernel<float>::run, &Kernel<double>::run,
+                };
+
+                return table[static_cast<int>(dtype)];
+            }
+        };
+
+        // a itself when its buffer holds exactly its elements in order. views such
+        // as a row of a matrix carry the buffer of their parent and are copied.
+        template<class T>
+        const array<T> &contiguous(const array<T> &a, array<T> &tmp) {
+            if (a.is_contiguous() && a.offset() == 0 && a.data().size() == elements(a))
+                return a;
+
+            tmp = a.flatten();
+            tmp.reshape(a.shape());
+
+            return tmp;
+        }
+    }
+
+    class dynamic_array {
+        using shape_t = std::deque<unsigned long>;
+
+        struct holder_base {
+            virtual ~holder_base() {}
+
+            virtual holder_base *clone() const = 0;
+        };
+
+        template<class T>
+        struct holder : holder_base {
+            explicit holder(array<T> value) : value(std::move(value)) {}
+
+            holder_base *clone() const override { return new holder<T>(value); }
+
+            array<T> value;
+        };
+
+    public:
+        //////////////////
+        // constructors //
+        //////////////////
+
+        // wraps a typed array without copying it
+        template<class T>
+        dynamic_array(array<T> value)
+                : m_dtype(dtype_of<T>::value),
+                  m_holder(new holder<T>(std::move(value))) {
+        }
+
+        dynamic_array(const shape_t &shape, dtype_t dtype)
+                : m_dtype(dtype),
+                  m_holder(kernel::dtype_table<__zeros>::at(dtype)(shape)) {
+        }
+
+        dynamic_array(const dynamic_array &other)
+                : m_dtype(other.m_dtype),
+                  m_holder(other.m_holder->clone()) {
+        }
+
+        dynamic_array(dynamic_array &&other) = default;
+
+        dynamic_array &operator=(dynamic_array other) {
+            std::swap(m_dtype, other.m_dtype);
+            std::swap(m_holder, other.m_holder);
+
+            return *this;
+        }
+
+        /////////////////////
+        // object accesors //
+        /////////////////////
+
+        dtype_t dtype() const { return m_dtype; }
+
+        const shape_t &shape() const { return kernel::dtype_table<__shape>::at(m_dtype)(*m_holder); }
+
+        unsigned long ndim() const { return shape().size(); }
+
+        std::string dump() const { return kernel::dtype_table<__dump>::at(m_dtype)(*m_holder); }
+
+        // the typed array behind this object, no copy is made
+        template<class T>
+        array<T> &get() {
+            return __typed<T>();
+        }
+
+        template<class T>
+        const array<T> &get() const {
+            return const_cast<dynamic_array *>(this)->__typed<T>();
+        }
+
+        // element wise conversion to another dtype
+        dynamic_array astype(dtype_t dtype) const {
+            if (dtype == m_dtype)
+                return *this;
+
+            return kernel::dtype_table<__astype>::at(dtype)(*this);
+        }
+
+        ///////////////////////////
+        //  arithmetic operators //
+        ///////////////////////////
+
+        // promotes both operands to a common dtype once and runs the typed kernel
+        friend dynamic_array apply(binary_op op, const dynamic_array &lhs, const dynamic_array &rhs) {
+            if (lhs.shape() != rhs.shape())
+                throw std::invalid_argument("operands could not be broadcast together");
+
+            auto dtype = promote_types(lhs.m_dtype, rhs.m_dtype);
+
+            // true division, like numpy
+            if (op == binary_op::divide && !is_floating(dtype))
+                dtype = dtype_t::float64;
+
+            if (dtype == lhs.m_dtype && dtype == rhs.m_dtype)
+                return __binary(op, dtype, lhs, rhs);
+
+            return __binary(op, dtype, lhs.astype(dtype), rhs.astype(dtype));
+        }
+
+        friend dynamic_array operator+(const dynamic_array &lhs, const dynamic_array &rhs) {
+            return apply(binary_op::add, lhs, rhs);
+        }
+
+        friend dynamic_array operator-(const dynamic_array &lhs, const dynamic_array &rhs) {
+            return apply(binary_op::subtract, lhs, rhs);
+        }
+
+        friend dynamic_array operator*(const dynamic_array &lhs, const dynamic_array &rhs) {
+            return apply(binary_op::multiply, lhs, rhs);
+        }
+
+        friend dynamic_array operator/(const dynamic_array &lhs, const dynamic_array &rhs) {
+            return apply(binary_op::divide, lhs, rhs);
+        }
+
+        friend std::ostream &operator<<(std::ostream &os, const dynamic_array &ar) {
+            return os << ar.dump();
+        }
+
+    private:
+        dtype_t m_dtype;
+        std::unique_ptr<holder_base> m_holder;
+
+        template<class T>
+        array<T> &__typed() {
+            if (dtype_of<T>::value != m_dtype)
+                throw std::invalid_argument(std::string("array holds ") + dtype_name(m_dtype) + " elements");
+
+            return static_cast<holder<T> &>(*m_holder).value;
+        }
+
+        ///////////////////
+        // typed kernels //
+        ///////////////////
+
+        template<class T>
+        struct __zeros {
+            static holder_base *run(const shape_t &shape) {
+                return new holder<T>(array<T>(shape, T()));
+            }
+        };
+
+        template<class T>
+        struct __shape {
+            static const shape_t &run(const holder_base &h) {
+                return static_cast<const holder<T> &>(h).value.shape();
+            }
+        };
+
+        template<class T>
+        struct __dump {
+            static std::string run(const holder_base &h) {
+                return static_cast<const holder<T> &>(h).value.dump();
+            }
+        };
+
+        template<class To>
+        struct __convert {
+            template<class From>
+            struct from {
+                static array<To> run(const dynamic_array &src) {
+                    array<From> tmp(shape_t{1}, From());
+                    auto &in = kernel::contiguous(src.get<From>(), tmp);
+                    auto &x = in.data();
+                    auto n = kernel::elements(in);
+
+                    buffer_t<To> out(n);
+
+                    for (unsigned long i = 0; i < n; ++i) {
+                        out[i] = static_cast<To>(x[i]);
+                    }
+
+                    return array<To>(std::move(out), in.shape());
+                }
+            };
+        };
+
+        template<class To>
+        struct __astype {
+            static dynamic_array run(const dynamic_array &src) {
+                return kernel::dtype_table<__convert<To>::template from>::at(src.m_dtype)(src);
+            }
+        };
+
+        template<class T>
+        struct __arithmetic {
+            static dynamic_array run(binary_op op, const dynamic_array &lhs, const dynamic_array &rhs) {
+                array<T> ta(shape_t{1}, T()), tb(shape_t{1}, T());
+                auto &a = kernel::contiguous(lhs.get<T>(), ta);
+                auto &b = kernel::contiguous(rhs.get<T>(), tb);
+
+                switch (op) {
+                    case binary_op::add: return __loop<T>(a, b, std::plus<T>());
+                    case binary_op::subtract: return __loop<T>(a, b, std::minus<T>());
+                    case binary_op::multiply: return __loop<T>(a, b, std::multiplies<T>());
+                    case binary_op::divide: return __loop<T>(a, b, std::divides<T>());
+                    case binary_op::maximum: return __loop<T>(a, b, [](const T &x, const T &y) { return x < y ? y : x; });
+                    case binary_op::minimum: return __loop<T>(a, b, [](const T &x, const T &y) { return y < x ? y : x; });
+                    case binary_op::equal: return __loop<bool>(a, b, std::equal_to<T>());
+                    case binary_op::less: return __loop<bool>(a, b, std::less<T>());
+                    default: return __loop<bool>(a, b, std::greater<T>());
+                }
+            }
+        };
+
+        template<class R, class T, typename callback>
+        static dynamic_array __loop(const array<T> &a, const array<T> &b, callback clb) {
+            auto &x = a.data();
+            auto &y = b.data();
+            auto n = kernel::elements(a);
+
+            buffer_t<R> out(n);
+
+            for (unsigned long i = 0; i < n; ++i) {
+                out[i] = static_cast<R>(clb(x[i], y[i]));
+            }
+
+            return array<R>(std::move(out), a.shape());
+        }
+
+        static dynamic_array __binary(binary_op op, dtype_t dtype, const dynamic_array &lhs,
+                                      const dynamic_array &rhs) {
+            return kernel::dtype_table<__arithmetic>::at(dtype)(op, lhs, rhs);
+        }
+    };
+
+    inline dynamic_array maximum(const dynamic_array &lhs, const dynamic_array &rhs) {
+        return apply(binary_op::maximum, lhs, rhs);
+    }
+
+    inline dynamic_array minimum(const dynamic_array &lhs, const dynamic_array &rhs) {
+        return apply(binary_op::minimum, lhs, rhs);
+    }
+
+    inline dynamic_array equal(const dynamic_array &lhs, const dynamic_array &rhs) {
+        return apply(binary_op::equal, lhs, rhs);
+    }
+
+    inline dynamic_array less(const dynamic_array &lhs, const dynamic_array &rhs) {
+        return apply(binary_op::less, lhs, rhs);
+    }
+
+    inline dynamic_array greater(const dynamic_array &lhs, const dynamic_array &rhs) {
+        return apply(binary_op::greater, lhs, rhs);
+    }
+}
+
+#endif //ARRAY_DYNAMIC_ARRAY_HPP
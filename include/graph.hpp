@@ -0,0 +1,690 @@
+/*
+MIT License
+
+Copyright (c) 2017 Jamie Cheng
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ARRAY_GRAPH_HPP
+#define ARRAY_GRAPH_HPP
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+#include "array.hpp"
+
+namespace nd {
+    namespace lazy {
+        enum class op_t : uint8_t {
+            input,
+            constant,
+            add,
+            subtract,
+            multiply,
+            divide,
+            maximum,
+            minimum,
+            negate,
+            exp,
+            log,
+            sqrt,
+            abs,
+            sum,
+            max,
+            dot,
+        };
+
+        inline bool is_elementwise(op_t op) { return op >= op_t::add && op <= op_t::abs; }
+
+        inline bool is_reduction(op_t op) { return op == op_t::sum || op == op_t::max; }
+
+        template<class T>
+        class graph;
+
+        template<class T>
+        class compiled_graph;
+
+        // handle on a node of a graph, operators on it record new nodes
+        template<class T>
+        class expr {
+        public:
+            expr(graph<T> *g, unsigned long id) : m_graph(g), m_id(id) {}
+
+            unsigned long id() const { return m_id; }
+
+            graph<T> *owner() const { return m_graph; }
+
+            expr sum() const { return m_graph->node(op_t::sum, m_id); }
+
+            expr max() const { return m_graph->node(op_t::max, m_id); }
+
+            friend expr operator+(const expr &a, const expr &b) { return __binary(op_t::add, a, b); }
+
+            friend expr operator-(const expr &a, const expr &b) { return __binary(op_t::subtract, a, b); }
+
+            friend expr operator*(const expr &a, const expr &b) { return __binary(op_t::multiply, a, b); }
+
+            friend expr operator/(const expr &a, const expr &b) { return __binary(op_t::divide, a, b); }
+
+            friend expr operator+(const expr &a, T b) { return a + a.m_graph->constant(b); }
+
+            friend expr operator-(const expr &a, T b) { return a - a.m_graph->constant(b); }
+
+            friend expr operator*(const expr &a, T b) { return a * a.m_graph->constant(b); }
+
+            friend expr operator/(const expr &a, T b) { return a / a.m_graph->constant(b); }
+
+            friend expr operator+(T a, const expr &b) { return b.m_graph->constant(a) + b; }
+
+            friend expr operator-(T a, const expr &b) { return b.m_graph->constant(a) - b; }
+
+            friend expr operator*(T a, const expr &b) { return b.m_graph->constant(a) * b; }
+
+            friend expr operator/(T a, const expr &b) { return b.m_graph->constant(a) / b; }
+
+            friend expr operator-(const expr &a) { return a.m_graph->node(op_t::negate, a.m_id); }
+
+            friend expr maximum(const expr &a, const expr &b) { return __binary(op_t::maximum, a, b); }
+
+            friend expr minimum(const expr &a, const expr &b) { return __binary(op_t::minimum, a, b); }
+
+            friend expr exp(const expr &a) { return a.m_graph->node(op_t::exp, a.m_id); }
+
+            friend expr log(const expr &a) { return a.m_graph->node(op_t::log, a.m_id); }
+
+            friend expr sqrt(const expr &a) { return a.m_graph->node(op_t::sqrt, a.m_id); }
+
+            friend expr abs(const expr &a) { return a.m_graph->node(op_t::abs, a.m_id); }
+
+            friend expr dot(const expr &a, const expr &b) { return __binary(op_t::dot, a, b); }
+
+        private:
+            graph<T> *m_graph;
+            unsigned long m_id;
+
+            // node ids only mean something inside their own graph
+            static expr __binary(op_t op, const expr &a, const expr &b) {
+                if (a.m_graph != b.m_graph)
+                    throw std::invalid_argument("operands belong to different graphs");
+
+                return a.m_graph->node(op, a.m_id, b.m_id);
+            }
+        };
+
+        // records operations instead of running them. identical operations on the
+        // same operands are recorded once, so repeated subexpressions are shared.
+        template<class T>
+        class graph {
+        public:
+            struct node_t {
+                op_t op;
+                long a, b;
+                T value;            // constants
+                unsigned long input; // inputs, position in run()
+            };
+
+            expr<T> input() {
+                m_nodes.push_back({op_t::input, -1, -1, T(), m_inputs++});
+                return expr<T>(this, m_nodes.size() - 1);
+            }
+
+            expr<T> constant(T value) {
+                return node(op_t::constant, -1, -1, value);
+            }
+
+            expr<T> node(op_t op, long a, long b = -1, T value = T()) {
+                auto key = std::make_tuple(static_cast<int>(op), a, b, __bits(value));
+                auto it = m_index.find(key);
+
+                if (it != m_index.end())
+                    return expr<T>(this, it->second);
+
+                m_nodes.push_back({op, a, b, value, 0});
+                m_index[key] = m_nodes.size() - 1;
+
+                return expr<T>(this, m_nodes.size() - 1);
+            }
+
+            const std::vector<node_t> &nodes() const { return m_nodes; }
+
+            unsigned long inputs() const { return m_inputs; }
+
+            compiled_graph<T> compile(const std::vector<expr<T>> &outputs) const {
+                return compiled_graph<T>(*this, outputs);
+            }
+
+            // structural key of the subgraph behind outputs, equal for graphs
+            // recorded by the same sequence of operations
+            std::string signature(const std::vector<expr<T>> &outputs) const {
+                std::stringstream ss;
+                std::vector<long> seen(m_nodes.size(), -1);
+                long next = 0;
+
+                ss << std::setprecision(std::numeric_limits<T>::max_digits10);
+                ss << m_inputs << ':' << outputs.size() << '|';
+
+                for (auto &out : outputs) {
+                    __signature(ss, out.id(), seen, next);
+                    ss << ';';
+                }
+
+                return ss.str();
+            }
+
+        private:
+            std::vector<node_t> m_nodes;
+            std::map<std::tuple<int, long, long, std::string>, unsigned long> m_index;
+            unsigned long m_inputs = 0;
+
+            // constants are keyed by their bytes, T's own ordering is not strict
+            // weak for nan
+            static std::string __bits(T value) {
+                std::string bits(sizeof(T), '\0');
+                std::memcpy(&bits[0], &value, sizeof(T));
+                return bits;
+            }
+
+            void __signature(std::stringstream &ss, unsigned long id, std::vector<long> &seen, long &next) const {
+                if (seen[id] >= 0) {
+                    ss << '#' << seen[id];
+                    return;
+                }
+
+                auto &n = m_nodes[id];
+                ss << static_cast<int>(n.op);
+
+                if (n.op == op_t::input) ss << 'i' << n.input;
+                if (n.op == op_t::constant) ss << 'c' << n.value;
+
+                if (n.a >= 0) {
+                    ss << '(';
+                    __signature(ss, n.a, seen, next);
+
+                    if (n.b >= 0) {
+                        ss << ',';
+                        __signature(ss, n.b, seen, next);
+                    }
+
+                    ss << ')';
+                }
+
+                seen[id] = next++;
+            }
+        };
+
+        // execution plan of a graph. elementwise chains are fused into single passes
+        // over blocks of elements, reductions are folded into the pass producing
+        // their operand and intermediate buffers are reused once they are dead.
+        // a plan does not refer back to its graph and can be run any number of times.
+        template<class T>
+        class compiled_graph {
+            using shape_t = std::deque<unsigned long>;
+            using vector_t = buffer_t<T>;
+
+            // elements per register of the fused kernels
+            static constexpr unsigned long block = 256;
+
+            enum class location_t : uint8_t {
+                input,
+                slot,
+                output,
+            };
+
+            struct value_t {
+                location_t where;
+                unsigned long index;
+            };
+
+            struct instruction {
+                op_t op;
+                unsigned long dst, a, b;
+                T value;
+            };
+
+            struct step {
+                unsigned long node;
+                op_t op;                           // dot, a reduction, or elementwise
+                std::vector<unsigned long> leaves; // materialized nodes read by the program
+                std::vector<instruction> program;
+                unsigned long registers;
+            };
+
+        public:
+            compiled_graph(const graph<T> &g, const std::vector<expr<T>> &outputs)
+                    : m_nodes(g.nodes()),
+                      m_inputs(g.inputs()),
+                      m_values(m_nodes.size()) {
+                auto n = m_nodes.size();
+                std::vector<bool> reachable(n, false);
+                std::vector<unsigned long> consumers(n, 0);
+                std::vector<bool> materialized(n, false);
+
+                for (auto &out : outputs) {
+                    if (out.owner() != &g)
+                        throw std::invalid_argument("output does not belong to this graph");
+
+                    reachable[out.id()] = true;
+                    m_outputs.push_back(out.id());
+                }
+
+                // ids are topologically ordered, walk backwards to mark what is needed
+                for (unsigned long i = n; i-- > 0;) {
+                    if (!reachable[i]) continue;
+
+                    auto &node = m_nodes[i];
+
+                    for (long child : {node.a, node.b}) {
+                        if (child < 0) continue;
+
+                        reachable[child] = true;
+                        ++consumers[child];
+
+                        if (node.op == op_t::dot) materialized[child] = true;
+                    }
+                }
+
+                for (unsigned long i = 0; i < n; ++i) {
+                    auto op = m_nodes[i].op;
+
+                    if (op == op_t::input || is_reduction(op) || op == op_t::dot)
+                        materialized[i] = true;
+                    else if (is_elementwise(op) && consumers[i] > 1)
+                        materialized[i] = true;
+                }
+
+                for (auto id : m_outputs) {
+                    materialized[id] = true;
+                }
+
+                for (unsigned long i = 0; i < n; ++i) {
+                    if (!reachable[i] || !materialized[i] || m_nodes[i].op == op_t::input) continue;
+
+                    step s;
+                    s.node = i;
+                    s.op = m_nodes[i].op;
+                    s.registers = 0;
+
+                    if (s.op == op_t::dot) {
+                        s.leaves = {static_cast<unsigned long>(m_nodes[i].a), static_cast<unsigned long>(m_nodes[i].b)};
+                    } else if (is_reduction(s.op)) {
+                        __emit(m_nodes[i].a, materialized, s);
+                    } else {
+                        __emit(i, materialized, s, true);
+                    }
+
+                    m_steps.push_back(s);
+                }
+
+                __plan_buffers();
+            }
+
+            // number of scratch buffers the intermediates are spread over
+            unsigned long buffers() const { return m_slots; }
+
+            unsigned long steps() const { return m_steps.size(); }
+
+            std::vector<array<T>> run(const std::vector<std::reference_wrapper<const array<T>>> &inputs) const {
+                if (inputs.size() != m_inputs)
+                    throw std::invalid_argument("wrong number of inputs for the graph");
+
+                std::vector<array<T>> flat;
+                std::vector<const vector_t *> input_data(m_inputs);
+                std::vector<shape_t> shapes(m_nodes.size());
+                std::vector<bool> scalars(m_nodes.size(), false);
+
+                flat.reserve(m_inputs);
+
+                for (unsigned long i = 0; i < m_nodes.size(); ++i) {
+                    if (m_nodes[i].op != op_t::input) continue;
+
+                    const array<T> &in = inputs[m_nodes[i].input];
+
+                    if (in.is_contiguous() && in.offset() == 0 && !in.is_scalar()) {
+                        input_data[m_nodes[i].input] = &in.data();
+                    } else {
+                        flat.push_back(in.flatten());
+                        input_data[m_nodes[i].input] = &flat.back().data();
+                    }
+
+                    shapes[i] = in.shape();
+                    scalars[i] = in.is_scalar();
+                }
+
+                std::vector<vector_t> slots(m_slots);
+                std::vector<vector_t> outputs(m_steps.size());
+
+                for (unsigned long s = 0; s < m_steps.size(); ++s) {
+                    auto &st = m_steps[s];
+                    auto &target = m_values[st.node].where == location_t::slot ? slots[m_values[st.node].index]
+                                                                               : outputs[s];
+
+                    if (st.op == op_t::dot) {
+                        __run_dot(st, input_data, slots, outputs, shapes, scalars, target);
+                    } else {
+                        __run_program(st, input_data, slots, outputs, shapes, scalars, target);
+                    }
+                }
+
+                std::vector<array<T>> ret;
+
+                for (unsigned long o = 0; o < m_outputs.size(); ++o) {
+                    auto id = m_outputs[o];
+
+                    if (m_nodes[id].op == op_t::input) {
+                        ret.push_back(inputs[m_nodes[id].input]);
+                        continue;
+                    }
+
+                    auto &buffer = outputs[m_values[id].index];
+                    auto last = std::find(m_outputs.begin() + o + 1, m_outputs.end(), id) == m_outputs.end();
+
+                    if (scalars[id])
+                        ret.push_back(array<T>(T(buffer.at(0))));
+                    else
+                        ret.push_back(array<T>(last ? std::move(buffer) : buffer, shapes[id]));
+                }
+
+                return ret;
+            }
+
+        private:
+            std::vector<typename graph<T>::node_t> m_nodes;
+            unsigned long m_inputs;
+            std::vector<value_t> m_values;
+            std::vector<unsigned long> m_outputs;
+            std::vector<step> m_steps;
+            unsigned long m_slots = 0;
+
+            // appends the instructions computing node id to the program of s and
+            // returns the register holding the result
+            unsigned long __emit(unsigned long id, const std::vector<bool> &materialized, step &s, bool root = false) {
+                auto &node = m_nodes[id];
+                instruction ins = {node.op, s.registers, 0, 0, node.value};
+
+                if (node.op == op_t::constant) {
+                    // a constant fills its register, the value is broadcast
+                } else if (materialized[id] && !root) {
+                    ins.op = op_t::input;
+                    ins.a = s.leaves.size();
+                    s.leaves.push_back(id);
+                } else {
+                    ins.a = __emit(node.a, materialized, s);
+                    if (node.b >= 0) ins.b = __emit(node.b, materialized, s);
+                    ins.dst = s.registers;
+                }
+
+                ++s.registers;
+                s.program.push_back(ins);
+
+                return ins.dst;
+            }
+
+            // assigns every intermediate to a scratch slot, slots are handed out
+            // again once the last step reading them is done
+            void __plan_buffers() {
+                std::vector<long> last_use(m_nodes.size(), -1);
+                std::vector<bool> is_output(m_nodes.size(), false);
+
+                for (auto id : m_outputs) is_output[id] = true;
+
+                for (unsigned long s = 0; s < m_steps.size(); ++s) {
+                    for (auto leaf : m_steps[s].leaves) last_use[leaf] = s;
+                }
+
+                std::vector<unsigned long> free_slots;
+
+                for (unsigned long s = 0; s < m_steps.size(); ++s) {
+                    auto id = m_steps[s].node;
+
+                    if (is_output[id]) {
+                        m_values[id] = {location_t::output, s};
+                    } else if (!free_slots.empty()) {
+                        m_values[id] = {location_t::slot, free_slots.back()};
+                        free_slots.pop_back();
+                    } else {
+                        m_values[id] = {location_t::slot, m_slots++};
+                    }
+
+                    for (auto leaf : m_steps[s].leaves) {
+                        if (last_use[leaf] == (long) s && m_values[leaf].where == location_t::slot &&
+                            m_nodes[leaf].op != op_t::input) {
+                            free_slots.push_back(m_values[leaf].index);
+                            last_use[leaf] = -1;
+                        }
+                    }
+                }
+
+                for (unsigned long i = 0; i < m_nodes.size(); ++i) {
+                    if (m_nodes[i].op == op_t::input) m_values[i] = {location_t::input, m_nodes[i].input};
+                }
+            }
+
+            const vector_t &__data(unsigned long id, const std::vector<const vector_t *> &inputs,
+                                   const std::vector<vector_t> &slots, const std::vector<vector_t> &outputs) const {
+                auto &v = m_values[id];
+
+                if (v.where == location_t::input) return *inputs[v.index];
+                if (v.where == location_t::slot) return slots[v.index];
+                return outputs[v.index];
+            }
+
+            void __run_dot(const step &st, const std::vector<const vector_t *> &inputs, std::vector<vector_t> &slots,
+                           std::vector<vector_t> &outputs, std::vector<shape_t> &shapes, std::vector<bool> &scalars,
+                           vector_t &target) const {
+                auto a = st.leaves[0], b = st.leaves[1];
+                auto sa = shapes[a], sb = shapes[b];
+
+                // leaves are contiguous, so gemm reads them and writes the planned
+                // buffer directly. the target never shares a buffer with its leaves.
+                auto x = __data(a, inputs, slots, outputs).data();
+                auto y = __data(b, inputs, slots, outputs).data();
+
+                if (sa.size() == 1) {
+                    if (sb.size() != 1 || sa[0] != sb[0])
+                        throw std::runtime_error("shapes are not aligned for dot product");
+
+                    T sum = T();
+
+                    for (unsigned long i = 0; i < sa[0]; ++i) {
+                        sum += x[i] * y[i];
+                    }
+
+                    target.assign(1, sum);
+                    scalars[st.node] = true;
+                    shapes[st.node] = shape_t{1};
+                } else if (sa.size() == 2) {
+                    if (sb.size() != 2 || sa[1] != sb[0])
+                        throw std::runtime_error("shapes are not aligned for dot product");
+
+                    target.resize(sa[0] * sb[1]);
+                    kernel::gemm(sa[0], sb[1], sa[1], T(1), x, sa[1], 1ul, y, sb[1], 1ul, T(), target.data(), sb[1], 1ul);
+
+                    scalars[st.node] = false;
+                    shapes[st.node] = shape_t{sa[0], sb[1]};
+                } else {
+                    throw std::invalid_argument("dot is only implemented for 1-d and 2-d arrays");
+                }
+            }
+
+            void __run_program(const step &st, const std::vector<const vector_t *> &inputs,
+                               std::vector<vector_t> &slots, std::vector<vector_t> &outputs,
+                               std::vector<shape_t> &shapes, std::vector<bool> &scalars, vector_t &target) const {
+                std::vector<const T *> leaves;
+                std::vector<bool> broadcast;
+                shape_t shape;
+                bool scalar = true;
+
+                for (auto leaf : st.leaves) {
+                    leaves.push_back(__data(leaf, inputs, slots, outputs).data());
+                    broadcast.push_back(scalars[leaf]);
+
+                    if (scalars[leaf]) continue;
+
+                    if (!scalar && shape != shapes[leaf])
+                        throw std::invalid_argument("operands could not be broadcast together");
+
+                    shape = shapes[leaf];
+                    scalar = false;
+                }
+
+                auto count = scalar ? 1ul : std::accumulate(shape.begin(), shape.end(), 1ul,
+                                                             std::multiplies<unsigned long>());
+                auto reduce = is_reduction(st.op);
+                auto result = st.program.back().dst;
+
+                scalars[st.node] = scalar || reduce;
+                shapes[st.node] = scalars[st.node] ? shape_t{1} : shape;
+
+                auto init = st.op == op_t::max ? kernel::lowest<T>() : T();
+                auto blocks = (count + block - 1) / block;
+
+                // one partial per block folded in block order, so the result does
+                // not depend on how blocks were spread over the workers
+                std::vector<T> partials(reduce ? blocks : 0, init);
+
+                target.resize(reduce ? 1 : count);
+
+                executor::instance().parallel_for(0, blocks, [&](unsigned long lo, unsigned long hi) {
+                    std::vector<T> regs(st.registers * block);
+
+                    for (unsigned long blk = lo; blk < hi; ++blk) {
+                        auto start = blk * block;
+                        auto len = count - start < block ? count - start : block;
+
+                        __execute(st, leaves, broadcast, start, len, regs);
+
+                        auto r = regs.data() + result * block;
+                        auto partial = init;
+
+                        if (st.op == op_t::sum) {
+                            for (unsigned long i = 0; i < len; ++i) partial += r[i];
+                        } else if (st.op == op_t::max) {
+                            for (unsigned long i = 0; i < len; ++i) partial = partial < r[i] ? r[i] : partial;
+                        } else {
+                            std::copy(r, r + len, target.begin() + start);
+                        }
+
+                        if (reduce) partials[blk] = partial;
+                    }
+                }, 16);
+
+                if (reduce) {
+                    auto total = init;
+
+                    for (auto partial : partials)
+                        total = st.op == op_t::sum ? total + partial : (total < partial ? partial : total);
+
+                    target[0] = total;
+                }
+            }
+
+            // runs the program of a step over len elements starting at start
+            static void __execute(const step &st, const std::vector<const T *> &leaves,
+                                  const std::vector<bool> &broadcast, unsigned long start, unsigned long len,
+                                  std::vector<T> &regs) {
+                for (auto &ins : st.program) {
+                    auto d = regs.data() + ins.dst * block;
+                    auto a = regs.data() + ins.a * block;
+                    auto b = regs.data() + ins.b * block;
+
+                    switch (ins.op) {
+                        case op_t::input:
+                            if (broadcast[ins.a]) std::fill(d, d + len, leaves[ins.a][0]);
+                            else std::copy(leaves[ins.a] + start, leaves[ins.a] + start + len, d);
+                            break;
+                        case op_t::constant:
+                            std::fill(d, d + len, ins.value);
+                            break;
+                        case op_t::add:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = a[i] + b[i];
+                            break;
+                        case op_t::subtract:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = a[i] - b[i];
+                            break;
+                        case op_t::multiply:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = a[i] * b[i];
+                            break;
+                        case op_t::divide:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = a[i] / b[i];
+                            break;
+                        case op_t::maximum:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = a[i] < b[i] ? b[i] : a[i];
+                            break;
+                        case op_t::minimum:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = b[i] < a[i] ? b[i] : a[i];
+                            break;
+                        case op_t::negate:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = -a[i];
+                            break;
+                        case op_t::exp:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = static_cast<T>(std::exp(a[i]));
+                            break;
+                        case op_t::log:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = static_cast<T>(std::log(a[i]));
+                            break;
+                        case op_t::sqrt:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = static_cast<T>(std::sqrt(a[i]));
+                            break;
+                        case op_t::abs:
+                            for (unsigned long i = 0; i < len; ++i) d[i] = a[i] < T() ? -a[i] : a[i];
+                            break;
+                        default:
+                            throw std::logic_error("unexpected operation in a fused kernel");
+                    }
+                }
+            }
+        };
+
+        // compiled plans keyed by graph structure, so graphs recorded again for
+        // every request are planned once
+        template<class T>
+        class plan_cache {
+        public:
+            std::shared_ptr<const compiled_graph<T>> compile(const graph<T> &g, const std::vector<expr<T>> &outputs) {
+                auto key = g.signature(outputs);
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_plans.find(key);
+
+                if (it != m_plans.end())
+                    return it->second;
+
+                auto plan = std::make_shared<const compiled_graph<T>>(g, outputs);
+                m_plans[key] = plan;
+
+                return plan;
+            }
+
+            unsigned long size() const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_plans.size();
+            }
+
+        private:
+            mutable std::mutex m_mutex;
+            std::unordered_map<std::string, std::shared_ptr<const compiled_graph<T>>> m_plans;
+        };
+    }
+}
+
+#endif //ARRAY_GRAPH_HPP
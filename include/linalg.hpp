@@ -0,0 +1,602 @@
+/*
+MIT License
+
+Copyright (c) 2017 Jamie Cheng
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ARRAY_LINALG_HPP
+#define ARRAY_LINALG_HPP
+
+#include "array.hpp"
+
+namespace nd {
+    namespace kernel {
+        // panel width of the blocked factorizations
+        constexpr unsigned long linalg_nb = 64;
+
+        // lu factorization with partial pivoting of a row major n x n matrix. l and
+        // u overwrite a, piv[j] is the row swapped with row j. returns false when
+        // a zero pivot was met.
+        template<class T>
+        bool getrf(unsigned long n, T *a, unsigned long lda, unsigned long *piv) {
+            bool regular = true;
+
+            for (unsigned long j0 = 0; j0 < n; j0 += linalg_nb) {
+                auto jb = std::min(linalg_nb, n - j0);
+
+                // unblocked factorization of the panel
+                for (unsigned long j = j0; j < j0 + jb; ++j) {
+                    auto p = j;
+
+                    for (unsigned long i = j + 1; i < n; ++i) {
+                        if (std::abs(a[i * lda + j]) > std::abs(a[p * lda + j])) p = i;
+                    }
+
+                    piv[j] = p;
+
+                    if (p != j)
+                        std::swap_ranges(a + j * lda, a + j * lda + n, a + p * lda);
+
+                    auto pivot = a[j * lda + j];
+
+                    if (pivot == T()) {
+                        regular = false;
+                        continue;
+                    }
+
+                    for (unsigned long i = j + 1; i < n; ++i) {
+                        auto l = a[i * lda + j] /= pivot;
+
+                        for (unsigned long k = j + 1; k < j0 + jb; ++k) {
+                            a[i * lda + k] -= l * a[j * lda + k];
+                        }
+                    }
+                }
+
+                auto rest = n - j0 - jb;
+
+                if (rest == 0)
+                    continue;
+
+                // u12 = l11^-1 * a12
+                for (unsigned long i = j0 + 1; i < j0 + jb; ++i) {
+                    for (unsigned long r = j0; r < i; ++r) {
+                        auto l = a[i * lda + r];
+
+                        for (unsigned long c = j0 + jb; c < n; ++c) {
+                            a[i * lda + c] -= l * a[r * lda + c];
+                        }
+                    }
+                }
+
+                // a22 -= l21 * u12
+                gemm(rest, rest, jb, T(-1),
+                     a + (j0 + jb) * lda + j0, lda, 1ul,
+                     a + j0 * lda + j0 + jb, lda, 1ul,
+                     T(1), a + (j0 + jb) * lda + j0 + jb, lda, 1ul);
+            }
+
+            return regular;
+        }
+
+        // solves a x = b in place of the n x nrhs matrix b, given the output of getrf
+        template<class T>
+        void getrs(unsigned long n, const T *a, unsigned long lda, const unsigned long *piv,
+                   unsigned long nrhs, T *b, unsigned long ldb) {
+            for (unsigned long j = 0; j < n; ++j) {
+                if (piv[j] != j)
+                    std::swap_ranges(b + j * ldb, b + j * ldb + nrhs, b + piv[j] * ldb);
+            }
+
+            for (unsigned long i = 0; i < n; ++i) {
+                for (unsigned long r = 0; r < i; ++r) {
+                    auto l = a[i * lda + r];
+
+                    for (unsigned long c = 0; c < nrhs; ++c) {
+                        b[i * ldb + c] -= l * b[r * ldb + c];
+                    }
+                }
+            }
+
+            for (unsigned long i = n; i-- > 0;) {
+                for (unsigned long r = i + 1; r < n; ++r) {
+                    auto u = a[i * lda + r];
+
+                    for (unsigned long c = 0; c < nrhs; ++c) {
+                        b[i * ldb + c] -= u * b[r * ldb + c];
+                    }
+                }
+
+                for (unsigned long c = 0; c < nrhs; ++c) {
+                    b[i * ldb + c] /= a[i * lda + i];
+                }
+            }
+        }
+
+        // cholesky factorization a = l l^t, l overwrites the lower triangle and the
+        // upper one is cleared. returns false when a is not positive definite.
+        template<class T>
+        bool potrf(unsigned long n, T *a, unsigned long lda) {
+            for (unsigned long j0 = 0; j0 < n; j0 += linalg_nb) {
+                auto jb = std::min(linalg_nb, n - j0);
+
+                for (unsigned long j = j0; j < j0 + jb; ++j) {
+                    auto d = a[j * lda + j];
+
+                    for (unsigned long k = j0; k < j; ++k) {
+                        d -= a[j * lda + k] * a[j * lda + k];
+                    }
+
+                    if (!(d > T()))
+                        return false;
+
+                    a[j * lda + j] = std::sqrt(d);
+
+                    for (unsigned long i = j + 1; i < n; ++i) {
+                        auto s = a[i * lda + j];
+
+                        for (unsigned long k = j0; k < j; ++k) {
+                            s -= a[i * lda + k] * a[j * lda + k];
+                        }
+
+                        a[i * lda + j] = s / a[j * lda + j];
+                    }
+                }
+
+                auto rest = n - j0 - jb;
+
+                if (rest == 0)
+                    continue;
+
+                // a22 -= l21 * l21^t
+                gemm(rest, rest, jb, T(-1),
+                     a + (j0 + jb) * lda + j0, lda, 1ul,
+                     a + (j0 + jb) * lda + j0, 1ul, lda,
+                     T(1), a + (j0 + jb) * lda + j0 + jb, lda, 1ul);
+            }
+
+            for (unsigned long i = 0; i < n; ++i) {
+                std::fill(a + i * lda + i + 1, a + i * lda + n, T());
+            }
+
+            return true;
+        }
+
+        // applies the reflector i - tau v v^t stored below the diagonal of column j
+        // of a to the columns [c0, c1) of the m row matrix b
+        template<class T>
+        void larf(unsigned long m, unsigned long j, const T *a, unsigned long lda, T tau,
+                  T *b, unsigned long ldb, unsigned long c0, unsigned long c1) {
+            if (tau == T())
+                return;
+
+            for (unsigned long c = c0; c < c1; ++c) {
+                auto s = b[j * ldb + c];
+
+                for (unsigned long i = j + 1; i < m; ++i) {
+                    s += a[i * lda + j] * b[i * ldb + c];
+                }
+
+                s *= tau;
+                b[j * ldb + c] -= s;
+
+                for (unsigned long i = j + 1; i < m; ++i) {
+                    b[i * ldb + c] -= s * a[i * lda + j];
+                }
+            }
+        }
+
+        // householder qr of a row major m x n matrix. r overwrites the upper
+        // triangle, the reflectors are kept below the diagonal with their scales
+        // in tau. the trailing matrix is updated a panel at a time through the
+        // compact wy form q = i - v t v^t.
+        template<class T>
+        void geqrf(unsigned long m, unsigned long n, T *a, unsigned long lda, T *tau) {
+            auto k = std::min(m, n);
+
+            for (unsigned long j0 = 0; j0 < k; j0 += linalg_nb) {
+                auto jb = std::min(linalg_nb, k - j0);
+
+                for (unsigned long j = j0; j < j0 + jb; ++j) {
+                    T norm = T();
+
+                    for (unsigned long i = j + 1; i < m; ++i) {
+                        norm += a[i * lda + j] * a[i * lda + j];
+                    }
+
+                    auto alpha = a[j * lda + j];
+
+                    if (norm == T()) {
+                        tau[j] = T();
+                    } else {
+                        auto beta = -std::copysign(std::sqrt(alpha * alpha + norm), alpha);
+                        auto scale = T(1) / (alpha - beta);
+
+                        tau[j] = (beta - alpha) / beta;
+
+                        for (unsigned long i = j + 1; i < m; ++i) {
+                            a[i * lda + j] *= scale;
+                        }
+
+                        a[j * lda + j] = beta;
+                    }
+
+                    larf(m, j, a, lda, tau[j], a, lda, j + 1, j0 + jb);
+                }
+
+                auto rest = n - j0 - jb;
+
+                if (rest == 0)
+                    continue;
+
+                auto rows = m - j0;
+                std::vector<T> v(rows * jb, T()), t(jb * jb, T()), w(jb * rest), tw(jb * rest);
+
+                for (unsigned long r = 0; r < rows; ++r) {
+                    for (unsigned long c = 0; c < jb && c <= r; ++c) {
+                        v[r * jb + c] = r == c ? T(1) : a[(j0 + r) * lda + j0 + c];
+                    }
+                }
+
+                // t is upper triangular with t[i][i] = tau_i
+                for (unsigned long i = 0; i < jb; ++i) {
+                    t[i * jb + i] = tau[j0 + i];
+
+                    for (unsigned long p = 0; p < i; ++p) {
+                        T z = T();
+
+                        for (unsigned long r = i; r < rows; ++r) {
+                            z += v[r * jb + p] * v[r * jb + i];
+                        }
+
+                        w[p] = z;
+                    }
+
+                    for (unsigned long p = 0; p < i; ++p) {
+                        T s = T();
+
+                        for (unsigned long q = p; q < i; ++q) {
+                            s += t[p * jb + q] * w[q];
+                        }
+
+                        t[p * jb + i] = -tau[j0 + i] * s;
+                    }
+                }
+
+                auto a2 = a + j0 * lda + j0 + jb;
+
+                // a2 -= v * (t^t * (v^t * a2))
+                gemm(jb, rest, rows, T(1), v.data(), 1ul, jb, a2, lda, 1ul, T(), w.data(), rest, 1ul);
+                gemm(jb, rest, jb, T(1), t.data(), 1ul, jb, w.data(), rest, 1ul, T(), tw.data(), rest, 1ul);
+                gemm(rows, rest, jb, T(-1), v.data(), jb, 1ul, tw.data(), rest, 1ul, T(1), a2, lda, 1ul);
+            }
+        }
+
+        // builds the first k columns of q from the output of geqrf
+        template<class T>
+        void orgqr(unsigned long m, unsigned long k, const T *a, unsigned long lda, const T *tau,
+                   T *q, unsigned long ldq) {
+            for (unsigned long i = 0; i < m; ++i) {
+                std::fill(q + i * ldq, q + i * ldq + k, T());
+                if (i < k) q[i * ldq + i] = T(1);
+            }
+
+            for (unsigned long j = k; j-- > 0;) {
+                larf(m, j, a, lda, tau[j], q, ldq, j, k);
+            }
+        }
+
+        // number of stacked matrices in an array of shape (..., m, n)
+        template<class T>
+        unsigned long linalg_batch(const array<T> &a) {
+            if (!a.is_array() || a.ndim() < 2)
+                throw std::invalid_argument("expected an array of at least two dimensions");
+
+            auto &shape = a.shape();
+
+            return std::accumulate(shape.begin(), shape.end() - 2, 1ul, std::multiplies<unsigned long>());
+        }
+
+        template<class T>
+        unsigned long linalg_square(const array<T> &a) {
+            auto &shape = a.shape();
+
+            if (a.ndim() < 2 || shape.at(a.ndim() - 1) != shape.at(a.ndim() - 2))
+                throw std::invalid_argument("last two dimensions of the array must be square");
+
+            return shape.back();
+        }
+
+        template<class T>
+        T *linalg_inplace(array<T> &a) {
+            if (!a.is_contiguous())
+                throw std::invalid_argument("in place factorization needs a contiguous array");
+
+            return kernel::access::data(a).data() + a.offset();
+        }
+
+        // right hand sides of solve and lstsq: (..., m) or (..., m, k) stacked like a
+        template<class T>
+        unsigned long linalg_rhs(const array<T> &a, const array<T> &b) {
+            auto vector = b.ndim() + 1 == a.ndim();
+
+            if (!b.is_array() || (!vector && b.ndim() != a.ndim()) ||
+                !std::equal(a.shape().begin(), a.shape().end() - 2, b.shape().begin()) ||
+                b.shape().at(a.ndim() - 2) != a.shape().at(a.ndim() - 2))
+                throw std::invalid_argument("right hand side does not match the matrix");
+
+            return vector ? 1 : b.shape().back();
+        }
+
+        // runs clb(i) for every matrix of the batch, the batch is spread over the executor
+        template<typename callback>
+        void linalg_for_each(unsigned long batch, callback clb) {
+            executor::instance().parallel_for(0, batch, [&](unsigned long lo, unsigned long hi) {
+                for (unsigned long i = lo; i < hi; ++i) clb(i);
+            });
+        }
+    }
+
+    namespace linalg {
+        // lu factorization in place, stacked matrices are factored independently.
+        // returns the pivot rows with shape (..., n).
+        template<class T>
+        array<unsigned long> lu_factor(array<T> &a) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto n = kernel::linalg_square(a);
+            auto data = kernel::linalg_inplace(a);
+
+            auto shape = a.shape();
+            shape.pop_back();
+
+            array<unsigned long> piv(shape, 0);
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                kernel::getrf(n, data + i * n * n, n, kernel::access::data(piv).data() + i * n);
+            });
+
+            return piv;
+        }
+
+        // cholesky factorization in place, a is replaced by its lower factor
+        template<class T>
+        void cho_factor(array<T> &a) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto n = kernel::linalg_square(a);
+            auto data = kernel::linalg_inplace(a);
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                if (!kernel::potrf(n, data + i * n * n, n))
+                    throw std::runtime_error("matrix is not positive definite");
+            });
+        }
+
+        template<class T>
+        array<T> cholesky(const array<T> &a) {
+            auto ret = a.flatten();
+            ret.reshape(a.shape());
+
+            cho_factor(ret);
+
+            return ret;
+        }
+
+        // householder qr in place: r in the upper triangle, reflectors below it.
+        // returns the reflector scales with shape (..., min(m, n)).
+        template<class T>
+        array<T> qr_factor(array<T> &a) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto data = kernel::linalg_inplace(a);
+            auto m = a.shape().at(a.ndim() - 2);
+            auto n = a.shape().back();
+            auto k = std::min(m, n);
+
+            auto shape = a.shape();
+            shape.pop_back();
+            shape.back() = k;
+
+            array<T> tau(shape, T());
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                kernel::geqrf(m, n, data + i * m * n, n, kernel::access::data(tau).data() + i * k);
+            });
+
+            return tau;
+        }
+
+        // reduced qr: q is (..., m, k) and r is (..., k, n) with k = min(m, n)
+        template<class T>
+        std::pair<array<T>, array<T>> qr(const array<T> &a) {
+            auto factored = a.flatten();
+            factored.reshape(a.shape());
+
+            auto tau = qr_factor(factored);
+            auto batch = kernel::linalg_batch(a);
+            auto m = a.shape().at(a.ndim() - 2);
+            auto n = a.shape().back();
+            auto k = std::min(m, n);
+
+            auto q_shape = a.shape(), r_shape = a.shape();
+            q_shape.back() = k;
+            r_shape.at(a.ndim() - 2) = k;
+
+            array<T> q(q_shape, T()), r(r_shape, T());
+            auto f = kernel::access::data(factored).data();
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                kernel::orgqr(m, k, f + i * m * n, n, kernel::access::data(tau).data() + i * k, kernel::access::data(q).data() + i * m * k, k);
+
+                for (unsigned long row = 0; row < k; ++row) {
+                    std::copy(f + i * m * n + row * n + row, f + i * m * n + (row + 1) * n,
+                              kernel::access::data(r).data() + i * k * n + row * n + row);
+                }
+            });
+
+            return std::make_pair(q, r);
+        }
+
+        // solves a x = b for square a. b is either a vector (..., n) or a matrix
+        // (..., n, k) per matrix of a.
+        template<class T>
+        array<T> solve(const array<T> &a, const array<T> &b) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto n = kernel::linalg_square(a);
+            auto nrhs = kernel::linalg_rhs(a, b);
+
+            auto lu = a.flatten();
+            auto x = b.flatten();
+            x.reshape(b.shape());
+
+            auto data = kernel::access::data(lu).data();
+            auto rhs = kernel::access::data(x).data();
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                std::vector<unsigned long> piv(n);
+
+                if (!kernel::getrf(n, data + i * n * n, n, piv.data()))
+                    throw std::runtime_error("singular matrix");
+
+                kernel::getrs(n, data + i * n * n, n, piv.data(), nrhs, rhs + i * n * nrhs, nrhs);
+            });
+
+            return x;
+        }
+
+        template<class T>
+        array<T> inv(const array<T> &a) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto n = kernel::linalg_square(a);
+
+            array<T> eye(a.shape(), T());
+
+            for (unsigned long i = 0; i < batch; ++i) {
+                for (unsigned long j = 0; j < n; ++j) {
+                    kernel::access::data(eye)[i * n * n + j * n + j] = T(1);
+                }
+            }
+
+            return solve(a, eye);
+        }
+
+        // determinant, a scalar for a single matrix and shape (...) for a stack
+        template<class T>
+        array<T> det(const array<T> &a) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto n = kernel::linalg_square(a);
+
+            auto lu = a.flatten();
+            auto data = kernel::access::data(lu).data();
+            buffer_t<T> ret(batch);
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                std::vector<unsigned long> piv(n);
+                T d = T(1);
+
+                kernel::getrf(n, data + i * n * n, n, piv.data());
+
+                for (unsigned long j = 0; j < n; ++j) {
+                    d *= piv[j] == j ? data[i * n * n + j * n + j] : -data[i * n * n + j * n + j];
+                }
+
+                ret[i] = d;
+            });
+
+            if (a.ndim() == 2)
+                return array<T>(std::move(ret[0]));
+
+            auto shape = a.shape();
+            shape.pop_back();
+            shape.pop_back();
+
+            return array<T>(std::move(ret), shape);
+        }
+
+        // least squares solution of a x = b through qr, a (..., m, n) needs m >= n
+        // and full column rank
+        template<class T>
+        array<T> lstsq(const array<T> &a, const array<T> &b) {
+            static_assert(std::is_floating_point<T>::value, "linalg needs a floating point element type");
+
+            auto batch = kernel::linalg_batch(a);
+            auto m = a.shape().at(a.ndim() - 2);
+            auto n = a.shape().back();
+            auto nrhs = kernel::linalg_rhs(a, b);
+
+            if (m < n)
+                throw std::invalid_argument("lstsq needs at least as many rows as columns");
+
+            auto factored = a.flatten();
+            factored.reshape(a.shape());
+
+            auto tau = qr_factor(factored);
+            auto y = b.flatten();
+            auto f = kernel::access::data(factored).data();
+
+            auto shape = b.shape();
+            shape.at(a.ndim() - 2) = n;
+
+            array<T> x(shape, T());
+
+            kernel::linalg_for_each(batch, [&](unsigned long i) {
+                auto r = f + i * m * n;
+                auto rhs = kernel::access::data(y).data() + i * m * nrhs;
+                auto out = kernel::access::data(x).data() + i * n * nrhs;
+
+                // y = q^t b
+                for (unsigned long j = 0; j < n; ++j) {
+                    kernel::larf(m, j, r, n, tau.data()[i * n + j], rhs, nrhs, 0, nrhs);
+                }
+
+                // r x = y[:n]
+                for (unsigned long row = n; row-- > 0;) {
+                    if (r[row * n + row] == T())
+                        throw std::runtime_error("matrix does not have full column rank");
+
+                    for (unsigned long c = 0; c < nrhs; ++c) {
+                        auto s = rhs[row * nrhs + c];
+
+                        for (unsigned long j = row + 1; j < n; ++j) {
+                            s -= r[row * n + j] * out[j * nrhs + c];
+                        }
+
+                        out[row * nrhs + c] = s / r[row * n + row];
+                    }
+                }
+            });
+
+            return x;
+        }
+    }
+}
+
+#endif //ARRAY_LINALG_HPP
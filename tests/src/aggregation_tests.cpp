@@ -0,0 +1,145 @@
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+using array = nd::array<double>;
+using counts = nd::array<unsigned long>;
+
+TEST(aggregation, histogram) {
+    array a = {0, 1, 1, 2, 2, 2, 3, 3, 3, 3};
+
+    auto hist = nd::histogram(a, 4);
+    EXPECT_EQ(hist.first, counts({1, 2, 3, 4}));
+    EXPECT_EQ(hist.second, array({0, 0.75, 1.5, 2.25, 3}));
+
+    auto ranged = nd::histogram(a, 2, 0., 2.);
+    EXPECT_EQ(ranged.first, counts({1, 5}));
+
+    auto edges = nd::histogram(a, array({0, 1, 3}));
+    EXPECT_EQ(edges.first, counts({1, 9}));
+
+    EXPECT_THROW(nd::histogram(a, array({1, 0})), std::invalid_argument);
+}
+
+TEST(aggregation, histogram_large) {
+    nd::buffer_t<float> values(1ul << 18);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uni(0, 1);
+
+    for (auto &val : values) {
+        val = uni(rng);
+    }
+
+    nd::array<float> a(std::move(values), {1ul << 18});
+
+    auto hist = nd::histogram(a, 16, 0., 1.);
+    unsigned long total = 0;
+
+    for (unsigned long i = 0; i < 16; ++i) {
+        auto expected = std::count_if(a.data().begin(), a.data().end(), [&](float v) {
+            return v >= hist.second.data()[i] && (i == 15 ? v <= 1 : v < hist.second.data()[i + 1]);
+        });
+
+        EXPECT_EQ(hist.first.data()[i], expected);
+        total += hist.first.data()[i];
+    }
+
+    EXPECT_EQ(total, 1ul << 18);
+}
+
+TEST(aggregation, bincount) {
+    nd::array<int> a = {0, 1, 1, 3, 1};
+
+    EXPECT_EQ(nd::bincount(a), counts({1, 3, 0, 1}));
+    EXPECT_EQ(nd::bincount(a, 6), counts({1, 3, 0, 1, 0, 0}));
+    EXPECT_EQ(nd::bincount(a, array({.5, 1, 1, 2, 1})), array({.5, 3, 0, 2}));
+
+    EXPECT_THROW(nd::bincount(nd::array<int>({1, -1})), std::invalid_argument);
+}
+
+TEST(aggregation, unique) {
+    array a = {3, 1, NAN, 2, 1, 3, NAN, 3};
+
+    auto ret = nd::unique_counts(a);
+    ASSERT_EQ(ret.first.size(), 4);
+    EXPECT_EQ(ret.first.data()[2], 3.);
+    EXPECT_TRUE(std::isnan(ret.first.data()[3]));
+    EXPECT_EQ(ret.second, counts({2, 1, 3, 2}));
+
+    EXPECT_EQ(nd::unique(nd::array<int>({{2, 2}, {0, 5}})), nd::array<int>({0, 2, 5}));
+}
+
+TEST(aggregation, group_by) {
+    nd::array<int> keys = {4, 2, 4, 7, 2, 4};
+    array values = {1, 2, 3, 4, 5, 6};
+
+    auto sum = nd::group_by(keys, values);
+    EXPECT_EQ(sum.first, nd::array<int>({2, 4, 7}));
+    EXPECT_EQ(sum.second, array({7, 10, 4}));
+
+    EXPECT_EQ(nd::group_by(keys, values, nd::reduce_op::mean).second, array({3.5, 10. / 3, 4}));
+    EXPECT_EQ(nd::group_by(keys, values, nd::reduce_op::max).second, array({5, 6, 4}));
+    EXPECT_EQ(nd::group_by(keys, values, nd::reduce_op::min).second, array({2, 1, 4}));
+
+    // sparse keys go through the hash path
+    nd::array<long> sparse = {1000000000000l, -5, 1000000000000l};
+    auto ret = nd::group_by(sparse, array({1, 2, 3}), nd::reduce_op::sum);
+    EXPECT_EQ(ret.first, nd::array<long>({-5, 1000000000000l}));
+    EXPECT_EQ(ret.second, array({2, 4}));
+
+    EXPECT_THROW(nd::group_by(keys, array({1, 2})), std::invalid_argument);
+}
+
+TEST(aggregation, group_by_wide_keys) {
+    // close together but far from zero, the range must not be measured in double
+    nd::array<long> close = {1700000000000000000l, 1700000000000000001l, 1700000000000000002l,
+                             1700000000000000300l, 1700000000000000001l};
+    auto ret = nd::group_by(close, array({1, 2, 3, 4, 5}));
+    EXPECT_EQ(ret.first, nd::array<long>({1700000000000000000l, 1700000000000000001l, 1700000000000000002l,
+                                          1700000000000000300l}));
+    EXPECT_EQ(ret.second, array({1, 7, 3, 4}));
+
+    nd::array<long> extremes = {std::numeric_limits<long>::max(), std::numeric_limits<long>::lowest(), 0};
+    ret = nd::group_by(extremes, array({1, 2, 3}));
+    EXPECT_EQ(ret.first, nd::array<long>({std::numeric_limits<long>::lowest(), 0, std::numeric_limits<long>::max()}));
+    EXPECT_EQ(ret.second, array({2, 3, 1}));
+
+    // nan keys form a single group, sorted last like unique_counts does
+    array floats = {2, NAN, 1, 2, NAN};
+    auto groups = nd::group_by(floats, array({1, 2, 3, 4, 5}));
+    ASSERT_EQ(groups.first.size(), 3);
+    EXPECT_EQ(groups.first.data()[0], 1);
+    EXPECT_EQ(groups.first.data()[1], 2);
+    EXPECT_TRUE(std::isnan(groups.first.data()[2]));
+    EXPECT_EQ(groups.second, array({3, 5, 7}));
+
+    // two distant keys take the sparse path whatever the number of values
+    nd::array<long> far(std::deque<unsigned long>({100000}), 0l);
+    far.item({99999}) = 1l << 20;
+    auto spread = nd::group_by(far, nd::full<double>({100000}, 1.0));
+    EXPECT_EQ(spread.first, nd::array<long>({0, 1l << 20}));
+    EXPECT_EQ(spread.second, array({99999, 1}));
+}
+
+TEST(aggregation, group_by_values) {
+    // integer means are not truncated
+    nd::array<int> keys = {1, 1, 2};
+    nd::array<int> values = {1, 2, 5};
+
+    EXPECT_EQ(nd::group_by(keys, values, nd::reduce_op::mean).second, array({1.5, 5}));
+    EXPECT_EQ(nd::group_by(keys, values).second, array({3, 5}));
+
+    // infinite values are their own minimum and maximum
+    auto inf = std::numeric_limits<double>::infinity();
+    auto up = nd::full<double>({3}, inf);
+    auto down = nd::full<double>({3}, -inf);
+
+    EXPECT_EQ(nd::group_by(keys, up, nd::reduce_op::min).second, nd::full<double>({2}, inf));
+    EXPECT_EQ(nd::group_by(keys, down, nd::reduce_op::max).second, nd::full<double>({2}, -inf));
+
+    array sparse = {1e300, -1e300, 1e300};
+    EXPECT_EQ(nd::group_by(sparse, up, nd::reduce_op::min).second, nd::full<double>({2}, inf));
+}
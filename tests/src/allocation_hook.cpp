@@ -0,0 +1,30 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// replaces the global allocation functions of the allocation_tests binary only.
+// kept apart from the tests so the compiler never sees a new expression paired
+// with the free below.
+std::atomic<long> allocations(0);
+std::atomic<bool> counting(false);
+
+void *operator new(std::size_t n) {
+    if (counting) ++allocations;
+
+    if (auto p = std::malloc(n ? n : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t n) {
+    return ::operator new(n);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
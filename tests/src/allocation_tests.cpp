@@ -0,0 +1,35 @@
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+// counters of allocation_hook.cpp
+extern std::atomic<long> allocations;
+extern std::atomic<bool> counting;
+
+TEST(allocation, parallel_for) {
+    nd::executor ex(4);
+    std::vector<double> data(4096, 0.);
+
+    auto pass = [&] {
+        ex.parallel_for(0, data.size(), [&](unsigned long lo, unsigned long hi) {
+            for (unsigned long i = lo; i < hi; ++i) data[i] += 1;
+        }, 64);
+    };
+
+    // the first call grows the chunk nodes of this thread
+    pass();
+
+    counting = true;
+
+    for (int i = 0; i < 100; ++i) {
+        pass();
+    }
+
+    counting = false;
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(data[0], 101);
+    EXPECT_EQ(data[4095], 101);
+}
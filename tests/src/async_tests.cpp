@@ -0,0 +1,146 @@
+#include <atomic>
+#include <future>
+#include <set>
+
+#include "gtest/gtest.h"
+
+#include "async.hpp"
+
+using array = nd::array<double>;
+
+TEST(async, dependencies) {
+    array a = {
+            {1, 2},
+            {3, 4}
+    };
+
+    auto fa = nd::make_ready_future(a);
+    auto fb = nd::async([](const array &x) { return x.transpose(); }, fa);
+    auto product = nd::async_dot(fa, fb);
+    auto total = nd::async_sum(product);
+
+    array expected = {
+            {5, 11},
+            {11, 25}
+    };
+
+    EXPECT_EQ(product.get(), expected);
+    EXPECT_EQ(total.get(), 52);
+    EXPECT_EQ(nd::async_sum(fa, 0).get(), array({4, 6}));
+    EXPECT_EQ(nd::async_dump(nd::make_ready_future(array(1.0))).get(), "1.000000");
+}
+
+TEST(async, error_propagation) {
+    auto bad = nd::async([]() -> array { throw std::runtime_error("load failed"); });
+    auto next = nd::async([](const array &x) { return x.sum(); }, bad);
+
+    EXPECT_THROW(next.get(), std::runtime_error);
+    EXPECT_TRUE(next.ready());
+}
+
+TEST(async, stream_order) {
+    std::vector<int> order;
+    nd::executor pool(4);
+
+    {
+        nd::stream s(pool);
+
+        for (int i = 0; i < 50; ++i) {
+            s.enqueue([&order, i] { order.push_back(i); });
+        }
+
+        s.synchronize();
+        EXPECT_EQ(order.size(), 50);
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(async, pipeline) {
+    nd::stream load, compute;
+    std::atomic<int> serialized(0);
+    std::vector<nd::future<std::string>> outputs;
+
+    for (int batch = 0; batch < 4; ++batch) {
+        auto input = load.enqueue([batch] { return array({4, 4}, static_cast<double>(batch)); });
+        auto result = compute.enqueue([](const array &x) { return x.dot(x); }, input);
+
+        outputs.push_back(nd::async([&serialized](const array &x) {
+            ++serialized;
+            return x.dump();
+        }, result));
+    }
+
+    for (auto &out : outputs) {
+        out.wait();
+    }
+
+    EXPECT_EQ(serialized, 4);
+    EXPECT_EQ(outputs[2].get(), array({4, 4}, 16.0).dump());
+}
+
+TEST(async, chunks_not_stuck_behind_tasks) {
+    nd::executor ex(2);
+    std::atomic<bool> started(false), release(false);
+
+    ex.submit([&] {
+        started = true;
+        while (!release) std::this_thread::yield();
+    });
+
+    while (!started) std::this_thread::yield();
+
+    // the chunk queued on the busy worker is stolen by the idle one
+    std::atomic<unsigned long> done(0);
+
+    ex.parallel_for(0, 2, [&](unsigned long lo, unsigned long hi) {
+        done += hi - lo;
+    });
+
+    EXPECT_EQ(done, 2);
+    release = true;
+}
+
+TEST(async, nested_parallel_for) {
+    nd::executor ex(3);
+    std::promise<void> done;
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::vector<int> hits(3 * 100, 0);
+    bool failed = false;
+
+    // a kernel inside a task spreads its chunks over the pool instead of running
+    // them all on the task's worker, nested calls included
+    ex.submit([&] {
+        ex.parallel_for(0, 3, [&](unsigned long lo, unsigned long hi) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }
+
+            for (unsigned long i = lo; i < hi; ++i) {
+                ex.parallel_for(i * 100, (i + 1) * 100, [&](unsigned long a, unsigned long b) {
+                    for (unsigned long k = a; k < b; ++k) ++hits[k];
+                }, 10);
+            }
+        });
+
+        try {
+            ex.parallel_for(0, 3, [](unsigned long, unsigned long) { throw std::runtime_error("chunk"); });
+        } catch (std::runtime_error &) {
+            failed = true;
+        }
+
+        done.set_value();
+    });
+
+    done.get_future().wait();
+
+    // the task worker may lose its own chunk to a thief, but never runs them all
+    EXPECT_GE(threads.size(), 2);
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 300);
+    EXPECT_TRUE(failed);
+}
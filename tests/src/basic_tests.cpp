@@ -1,12 +1,14 @@
 #include "gtest/gtest.h"
 
+#include <future>
+
 #include "array.hpp"
 
 using array = nd::array<double>;
 
 TEST(basic_op, data) {
     array array1d = {1, 2, 3, 4, 5};
-    std::vector<double> vec = {1, 2, 3, 4, 5};
+    nd::buffer_t<double> vec = {1, 2, 3, 4, 5};
 
     EXPECT_EQ(array1d.data(), vec);
 
@@ -14,7 +16,7 @@ TEST(basic_op, data) {
             {1, 2, 3},
             {4, 5, 6}
     };
-    std::vector<double> vec2 = {1, 2, 3, 4, 5, 6};
+    nd::buffer_t<double> vec2 = {1, 2, 3, 4, 5, 6};
 
     EXPECT_EQ(array2d.data(), vec2);
 }
@@ -116,3 +118,72 @@ TEST(basic_op, compare) {
         EXPECT_NE(a, a1);
     }
 }
+
+TEST(basic_op, placement) {
+    auto policy = nd::get_placement();
+    std::deque<unsigned long> shape = {1ul << 17};
+
+    for (auto p : {nd::placement::first_touch, nd::placement::interleave, nd::placement::local}) {
+        nd::set_placement(p);
+
+        array a(shape, 2.0);
+        EXPECT_EQ(a.size(), 1ul << 17);
+        EXPECT_TRUE(std::all_of(a.data().begin(), a.data().end(), [](double v) { return v == 2.0; }));
+
+        a *= 3.0;
+        a += a;
+        EXPECT_EQ(a.data().front(), 12.0);
+        EXPECT_EQ(a.data().back(), 12.0);
+    }
+
+    nd::set_placement(policy);
+}
+
+TEST(basic_op, pin_workers) {
+    nd::executor ex(2);
+
+#ifdef __linux__
+    EXPECT_TRUE(ex.pin_workers());
+#else
+    EXPECT_FALSE(ex.pin_workers());
+#endif
+
+    // pinned workers still run every chunk
+    std::vector<int> hits(1000, 0);
+
+    ex.parallel_for(0, hits.size(), [&](unsigned long lo, unsigned long hi) {
+        for (unsigned long i = lo; i < hi; ++i) ++hits[i];
+    });
+
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 1000);
+}
+
+TEST(basic_op, nested_executors) {
+    nd::executor outer(1), inner(2);
+    std::promise<void> done;
+
+    std::thread::id caller;
+    std::vector<std::thread::id> ids(2);
+    bool in_outer = false, in_inner = true;
+
+    // a worker of outer is an ordinary caller for inner, its chunks go to inner's workers
+    outer.submit([&] {
+        caller = std::this_thread::get_id();
+        in_outer = outer.in_worker();
+        in_inner = inner.in_worker();
+
+        inner.parallel_for(0, 2, [&](unsigned long lo, unsigned long hi) {
+            for (unsigned long i = lo; i < hi; ++i) ids[i] = std::this_thread::get_id();
+        });
+
+        done.set_value();
+    });
+
+    done.get_future().wait();
+
+    EXPECT_TRUE(in_outer);
+    EXPECT_FALSE(in_inner);
+    EXPECT_FALSE(outer.in_worker());
+    EXPECT_NE(ids[0], caller);
+    EXPECT_NE(ids[1], caller);
+}
@@ -36,3 +36,75 @@ TEST(calculation, sum) {
     EXPECT_EQ(b[0][1], exp4);
 }
 
+
+TEST(calculation, reductions) {
+    array a = {
+            {1, 2, 3},
+            {4, 5, 6}
+    };
+
+    EXPECT_EQ(a.sum(), 21);
+    EXPECT_EQ(a.min(), 1);
+    EXPECT_EQ(a.max(), 6);
+    EXPECT_EQ(a.mean(), 3.5);
+
+    EXPECT_EQ(a.sum(0), array({5, 7, 9}));
+    EXPECT_EQ(a.sum(-1), array({6, 15}));
+    EXPECT_EQ(a.max(1), array({3, 6}));
+    EXPECT_EQ(a.mean(0), array({2.5, 3.5, 4.5}));
+
+    EXPECT_EQ(a.transpose().sum(0), array({6, 15}));
+    EXPECT_EQ(a[1].sum(0), array(15));
+
+    array large({1000, 100}, 0.5);
+    EXPECT_EQ(large.sum(), 50000);
+
+    nd::array<int> ints = {
+            {1, 2},
+            {2, 4}
+    };
+
+    EXPECT_EQ(ints.mean(), 2.25);
+    EXPECT_EQ(ints.mean(0), array({1.5, 3}));
+}
+
+TEST(calculation, infinite_extremes) {
+    auto inf = std::numeric_limits<double>::infinity();
+
+    auto up = nd::full<double>({2, 3}, inf);
+    auto down = nd::full<double>({2, 3}, -inf);
+
+    EXPECT_EQ(up.min(), inf);
+    EXPECT_EQ(down.max(), -inf);
+    EXPECT_EQ(up.min(0), nd::full<double>({3}, inf));
+    EXPECT_EQ(down.max(1), nd::full<double>({2}, -inf));
+
+    array rows = nd::zeros<double>({2});
+    EXPECT_EQ(up.min(1, rows), nd::full<double>({2}, inf));
+    EXPECT_EQ(down.max(1, rows), nd::full<double>({2}, -inf));
+
+    nd::array<int> ints = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+    EXPECT_EQ(ints.min(), std::numeric_limits<int>::max());
+}
+
+TEST(calculation, reduction_order) {
+    array a(std::deque<unsigned long>({2000000}), 0.0);
+    a.random(-1, 1);
+
+    // partials are folded per block of kernel::grain elements in block order
+    double expected = 0;
+
+    for (unsigned long first = 0; first < a.size(); first += nd::kernel::grain) {
+        double partial = 0;
+
+        for (unsigned long i = first; i < std::min(a.size(), first + nd::kernel::grain); ++i) {
+            partial += a.data()[i];
+        }
+
+        expected += partial;
+    }
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(a.sum(), expected);
+    }
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+using array = nd::array<double>;
+
+TEST(comparison, shape_mismatch) {
+    array a = {1, 2, 3};
+    array b = {1, 2, 3, 4};
+    array c = {
+            {1, 2, 3},
+            {4, 5, 6}
+    };
+
+    EXPECT_NE(a, b);
+    EXPECT_NE(b, a);
+    EXPECT_NE(a, c);
+    EXPECT_FALSE(nd::array_equal(c, a));
+}
+
+TEST(comparison, strided) {
+    array a = {
+            {1, 2, 3},
+            {4, 5, 6}
+    };
+
+    array t = {
+            {1, 4},
+            {2, 5},
+            {3, 6}
+    };
+
+    EXPECT_TRUE(nd::array_equal(a.transpose(), t));
+    EXPECT_TRUE(nd::array_equal(t, a.transpose()));
+    EXPECT_TRUE(nd::array_equal(a.transpose().transpose(), a));
+}
+
+TEST(comparison, mask) {
+    nd::array<int> a = {
+            {1, 5, 3},
+            {4, 2, 6}
+    };
+
+    nd::array<int> b = {
+            {1, 2, 3},
+            {4, 5, 6}
+    };
+
+    auto eq = a.equal(b);
+    EXPECT_EQ(eq.shape(), a.shape());
+    EXPECT_EQ(eq.data(), nd::buffer_t<bool>({true, false, true, true, false, true}));
+
+    EXPECT_EQ(a.less(b).data(), nd::buffer_t<bool>({false, false, false, false, true, false}));
+    EXPECT_EQ(a.greater_equal(4).data(), nd::buffer_t<bool>({false, true, false, true, false, true}));
+
+    // a transposed view is compared in logical order
+    EXPECT_EQ(a.transpose().not_equal(b.transpose()).data(),
+              nd::buffer_t<bool>({false, false, true, true, false, false}));
+
+    EXPECT_THROW(a.equal(nd::array<int>({1, 2, 3})), std::invalid_argument);
+}
+
+TEST(comparison, isclose) {
+    array a = {1.0, 2.0, 1e10, NAN};
+    array b = {1.0 + 1e-9, 2.1, 1.00001e10, NAN};
+
+    EXPECT_EQ(nd::isclose(a, b).data(), nd::buffer_t<bool>({true, false, true, false}));
+    EXPECT_EQ(nd::isclose(a, b, 1e-05, 1e-08, true).data(), nd::buffer_t<bool>({true, false, true, true}));
+
+    array c = {1.0, 2.0, 3.0};
+    array d = {1.0 + 1e-9, 2.0, 3.0 - 1e-9};
+
+    EXPECT_TRUE(nd::allclose(c, d));
+    EXPECT_FALSE(nd::allclose(c, d, 0, 1e-12));
+
+    // incompatible shapes throw from both, like numpy
+    array e = {1.0, 2.0};
+    EXPECT_THROW(nd::isclose(c, e), std::invalid_argument);
+    EXPECT_THROW(nd::allclose(c, e), std::invalid_argument);
+    EXPECT_THROW(nd::isclose(c, array(1.0)), std::invalid_argument);
+    EXPECT_THROW(nd::allclose(c, array(1.0)), std::invalid_argument);
+    EXPECT_TRUE(nd::allclose(array(1.0), array(1.0 + 1e-9)));
+}
+
+TEST(comparison, large_masks) {
+    // odd size so the last 64 bit word of the mask is partial
+    auto a = nd::arange(0., 100003.);
+    auto b = nd::full_like(a, 50000.);
+
+    auto mask = a.less(50000.);
+    EXPECT_EQ(std::count(mask.data().begin(), mask.data().end(), true), 50000);
+    EXPECT_EQ(mask, a.less(b));
+    EXPECT_TRUE(mask.data()[49999]);
+    EXPECT_FALSE(mask.data()[50000]);
+
+    nd::array<int> m = {{1, 2}, {3, 4}};
+    EXPECT_EQ(m.transpose().greater(1).data(), nd::buffer_t<bool>({false, true, true, true}));
+}
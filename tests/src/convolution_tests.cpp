@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+using array = nd::array<double>;
+
+TEST(convolution, convolve_1d) {
+    array a = {1, 2, 3};
+    array v = {0, 1, 0.5};
+
+    array full = {0, 1, 2.5, 4, 1.5};
+    array same = {1, 2.5, 4};
+    array valid = {2.5};
+
+    EXPECT_EQ(nd::convolve(a, v), full);
+    EXPECT_EQ(nd::convolve(a, v, nd::conv_mode::same), same);
+    EXPECT_EQ(nd::convolve(a, v, nd::conv_mode::valid), valid);
+}
+
+TEST(convolution, correlate_1d) {
+    array a = {1, 2, 3};
+    array v = {0, 1, 0.5};
+
+    array full = {0.5, 2, 3.5, 3, 0};
+
+    EXPECT_EQ(nd::correlate(a, v, nd::conv_mode::full), full);
+    EXPECT_EQ(nd::correlate(a, v), array({3.5}));
+}
+
+TEST(convolution, stride_dilation) {
+    nd::array<int> a = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    nd::array<int> v = {1, 1};
+
+    nd::array<int> dilated = {2, 4, 6, 8, 10, 12, 14, 16};
+    nd::array<int> strided = {2, 8, 14};
+
+    EXPECT_EQ(nd::correlate(a, v, nd::conv_mode::valid, 1, 2), dilated);
+    EXPECT_EQ(nd::correlate(a, v, nd::conv_mode::valid, 3, 2), strided);
+}
+
+TEST(convolution, correlate_2d) {
+    array x = {
+            {1, 2, 3},
+            {4, 5, 6},
+            {7, 8, 9}
+    };
+
+    array k = {
+            {1, 0},
+            {0, 1}
+    };
+
+    array valid = {
+            {6, 8},
+            {12, 14}
+    };
+
+    array full = {
+            {1, 2, 3, 0},
+            {4, 6, 8, 3},
+            {7, 12, 14, 6},
+            {0, 7, 8, 9}
+    };
+
+    EXPECT_EQ(nd::correlate(x, k), valid);
+    EXPECT_EQ(nd::correlate(x, k, nd::conv_mode::full), full);
+    EXPECT_EQ(nd::convolve(x, k, nd::conv_mode::same).shape(), x.shape());
+    EXPECT_THROW(nd::correlate(k, x), std::invalid_argument);
+}
+
+TEST(convolution, methods_agree) {
+    array x({20, 30}, 0.0);
+    array k({7, 9}, 0.0);
+
+    x.random(-1, 1);
+    k.random(-1, 1);
+
+    for (auto mode : {nd::conv_mode::full, nd::conv_mode::same, nd::conv_mode::valid}) {
+        auto direct = nd::convolve(x, k, mode, 1, 2, nd::conv_method::direct);
+
+        EXPECT_TRUE(nd::allclose(direct, nd::convolve(x, k, mode, 1, 2, nd::conv_method::im2col)));
+        EXPECT_TRUE(nd::allclose(direct, nd::convolve(x, k, mode, 1, 2, nd::conv_method::fft)));
+
+        auto strided = nd::correlate(x, k, mode, 3, 1, nd::conv_method::direct);
+
+        EXPECT_TRUE(nd::allclose(strided, nd::correlate(x, k, mode, 3, 1, nd::conv_method::im2col)));
+        EXPECT_TRUE(nd::allclose(strided, nd::correlate(x, k, mode, 3, 1, nd::conv_method::fft)));
+    }
+}
+
+TEST(convolution, im2col_slices) {
+    // 32 x 32 taps over 100 x 100 positions needs more scratch than one slice
+    array x({100, 100}, 0.0);
+    array k({32, 32}, 0.0);
+
+    x.random(-1, 1);
+    k.random(-1, 1);
+
+    auto direct = nd::correlate(x, k, nd::conv_mode::same, 1, 1, nd::conv_method::direct);
+
+    EXPECT_TRUE(nd::allclose(direct, nd::correlate(x, k, nd::conv_mode::same, 1, 1, nd::conv_method::im2col)));
+}
+
+TEST(convolution, sliding_window_view) {
+    array a = {1, 2, 3, 4, 5};
+
+    array windows = {
+            {1, 2, 3},
+            {2, 3, 4},
+            {3, 4, 5}
+    };
+
+    EXPECT_EQ(a.sliding_window_view({3}), windows);
+
+    array b = {
+            {1, 2, 3},
+            {4, 5, 6}
+    };
+
+    auto view = b.sliding_window_view({2, 2});
+
+    EXPECT_EQ(view.shape(), std::deque<unsigned long>({1, 2, 2, 2}));
+    EXPECT_EQ(view[0][1], array({{2, 3}, {5, 6}}));
+    EXPECT_THROW(b.sliding_window_view({3, 1}), std::invalid_argument);
+}
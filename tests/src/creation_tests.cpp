@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+using array = nd::array<double>;
+
+TEST(creation, fill) {
+    auto a = nd::zeros<double>({2, 3});
+    EXPECT_EQ(a, array({{0, 0, 0}, {0, 0, 0}}));
+
+    EXPECT_EQ(nd::ones_like(a), array({{1, 1, 1}, {1, 1, 1}}));
+    EXPECT_EQ(nd::full_like(a, 7.), nd::full<double>({2, 3}, 7.));
+
+    EXPECT_EQ(nd::eye<double>(3), array({{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}));
+    EXPECT_EQ(nd::eye<double>(2, 3, 1), array({{0, 1, 0}, {0, 0, 1}}));
+}
+
+TEST(creation, ranges) {
+    EXPECT_EQ(nd::arange(0., 5.), array({0, 1, 2, 3, 4}));
+    EXPECT_EQ(nd::arange(1., 2., .25), array({1, 1.25, 1.5, 1.75}));
+    EXPECT_EQ(nd::arange(5, 0, -2), nd::array<int>({5, 3, 1}));
+    EXPECT_EQ(nd::arange(3., 1.).size(), 0);
+
+    EXPECT_EQ(nd::linspace(0., 1., 5), array({0, .25, .5, .75, 1}));
+    EXPECT_EQ(nd::linspace(0., 1., 4, false), array({0, .25, .5, .75}));
+
+    array b(std::deque<unsigned long>({6}), 0.);
+    b.arrange(2, 6);
+    EXPECT_EQ(b, array({2, 3, 4, 5, 0, 0}));
+}
+
+TEST(creation, concatenate) {
+    array a = {{1, 2}, {3, 4}};
+    array b = {{5, 6}};
+    array c = {{7}, {8}};
+
+    EXPECT_EQ(nd::concatenate(std::vector<array>{a, b}), array({{1, 2}, {3, 4}, {5, 6}}));
+    EXPECT_EQ(nd::concatenate(std::vector<array>{a, c}, 1), array({{1, 2, 7}, {3, 4, 8}}));
+    EXPECT_EQ(nd::concatenate(std::vector<array>{a.transpose(), c}, 1), array({{1, 3, 7}, {2, 4, 8}}));
+    EXPECT_THROW(nd::concatenate(std::vector<array>{a, c}), std::invalid_argument);
+}
+
+TEST(creation, stack) {
+    array a = {1, 2, 3};
+    array b = {4, 5, 6};
+
+    EXPECT_EQ(nd::stack(std::vector<array>{a, b}), array({{1, 2, 3}, {4, 5, 6}}));
+    EXPECT_EQ(nd::stack(std::vector<array>{a, b}, 1), array({{1, 4}, {2, 5}, {3, 6}}));
+
+    std::vector<array> samples(1000, nd::full<double>({4, 8}, 1.));
+    auto batch = nd::stack(samples);
+    EXPECT_EQ(batch.shape(), std::deque<unsigned long>({1000, 4, 8}));
+    EXPECT_EQ(batch.sum(), 32000.);
+}
+
+TEST(creation, split) {
+    array a = {{1, 2, 3, 4}, {5, 6, 7, 8}};
+
+    auto halves = nd::split(a, 2, 1);
+    ASSERT_EQ(halves.size(), 2);
+    EXPECT_EQ(halves[0], array({{1, 2}, {5, 6}}));
+    EXPECT_EQ(halves[1], array({{3, 4}, {7, 8}}));
+    EXPECT_EQ(nd::concatenate(halves, 1), a);
+
+    auto pieces = nd::split(a, std::vector<unsigned long>{1, 3}, 1);
+    ASSERT_EQ(pieces.size(), 3);
+    EXPECT_EQ(pieces[1], array({{2, 3}, {6, 7}}));
+
+    EXPECT_THROW(nd::split(a, 3, 1), std::invalid_argument);
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "dynamic_array.hpp"
+
+TEST(dynamic_array, promote_types) {
+    using nd::dtype_t;
+
+    EXPECT_EQ(nd::promote_types(dtype_t::int8, dtype_t::int32), dtype_t::int32);
+    EXPECT_EQ(nd::promote_types(dtype_t::uint8, dtype_t::int8), dtype_t::int16);
+    EXPECT_EQ(nd::promote_types(dtype_t::uint32, dtype_t::int64), dtype_t::int64);
+    EXPECT_EQ(nd::promote_types(dtype_t::uint64, dtype_t::int64), dtype_t::float64);
+    EXPECT_EQ(nd::promote_types(dtype_t::int16, dtype_t::float32), dtype_t::float32);
+    EXPECT_EQ(nd::promote_types(dtype_t::int32, dtype_t::float32), dtype_t::float64);
+    EXPECT_EQ(nd::promote_types(dtype_t::bool_, dtype_t::uint16), dtype_t::uint16);
+    EXPECT_EQ(nd::promote_types(dtype_t::float64, dtype_t::float32), dtype_t::float64);
+}
+
+TEST(dynamic_array, zero_copy_view) {
+    nd::dynamic_array a(nd::array<int32_t>({1, 2, 3}));
+
+    EXPECT_EQ(a.dtype(), nd::dtype_t::int32);
+    EXPECT_EQ(a.shape(), std::deque<unsigned long>({3}));
+
+    auto &typed = a.get<int32_t>();
+    typed += 9;
+
+    EXPECT_EQ(a.get<int32_t>().data().at(0), 10);
+    EXPECT_THROW(a.get<double>(), std::invalid_argument);
+}
+
+TEST(dynamic_array, astype) {
+    nd::dynamic_array a(nd::array<double>({1.5, -2.5, 0}));
+
+    auto i = a.astype(nd::dtype_t::int16);
+    EXPECT_EQ(i.dtype(), nd::dtype_t::int16);
+    EXPECT_EQ(i.get<int16_t>(), nd::array<int16_t>({1, -2, 0}));
+
+    auto b = a.astype(nd::dtype_t::bool_);
+    EXPECT_EQ(b.get<bool>().data(), nd::buffer_t<bool>({true, true, false}));
+}
+
+TEST(dynamic_array, arithmetic) {
+    nd::dynamic_array a(nd::array<uint8_t>({{1, 2}, {3, 4}}));
+    nd::dynamic_array b(nd::array<int8_t>({{-1, -1}, {1, 1}}));
+    nd::dynamic_array f(nd::array<float>({{0.5, 0.5}, {0.5, 0.5}}));
+
+    auto sum = a + b;
+    EXPECT_EQ(sum.dtype(), nd::dtype_t::int16);
+    EXPECT_EQ(sum.get<int16_t>(), nd::array<int16_t>({{0, 1}, {4, 5}}));
+
+    auto scaled = a * f;
+    EXPECT_EQ(scaled.dtype(), nd::dtype_t::float32);
+    EXPECT_EQ(scaled.get<float>(), nd::array<float>({{0.5, 1}, {1.5, 2}}));
+
+    auto ratio = a / a;
+    EXPECT_EQ(ratio.dtype(), nd::dtype_t::float64);
+
+    auto mask = nd::greater(a, b);
+    EXPECT_EQ(mask.dtype(), nd::dtype_t::bool_);
+    EXPECT_EQ(mask.get<bool>().data(), nd::buffer_t<bool>({true, true, true, true}));
+
+    EXPECT_EQ(nd::maximum(b, f).get<float>(), nd::array<float>({{0.5, 0.5}, {1, 1}}));
+    EXPECT_THROW(a + nd::dynamic_array(nd::array<uint8_t>({1, 2})), std::invalid_argument);
+}
+
+TEST(dynamic_array, row_view) {
+    nd::array<double> m = {{1, 2, 3}, {4, 5, 6}};
+    nd::dynamic_array e(nd::array<double>({1, 1, 1}));
+
+    // a row view still carries the whole buffer of m
+    nd::dynamic_array first(m[0]);
+    nd::dynamic_array second(m[1]);
+
+    EXPECT_EQ((first + e).get<double>(), nd::array<double>({2, 3, 4}));
+    EXPECT_EQ((second + e).get<double>(), nd::array<double>({5, 6, 7}));
+    EXPECT_EQ(second.astype(nd::dtype_t::int32).get<int32_t>(), nd::array<int32_t>({4, 5, 6}));
+}
@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include "graph.hpp"
+
+using array = nd::array<double>;
+
+TEST(graph, common_subexpressions) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto a = x * 2.0 + 1.0;
+    auto b = x * 2.0 + 1.0;
+
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_NE((x * 3.0).id(), a.id());
+}
+
+TEST(graph, nan_constants) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    auto a = x + nan;
+    auto b = x + 1.0;
+    auto c = x + nan;
+    auto d = x + 2.0;
+
+    EXPECT_EQ(a.id(), c.id());
+    EXPECT_NE(b.id(), d.id());
+    EXPECT_NE(a.id(), b.id());
+    EXPECT_EQ((x + 1.0).id(), b.id());
+}
+
+TEST(graph, fused_elementwise) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto w = g.input();
+    auto y = maximum(x * 2.0 - w, -x) / 2.0;
+    auto total = y.sum();
+
+    auto plan = g.compile({y, total});
+
+    // y is an output, so it is written once and the sum reads it back
+    EXPECT_EQ(plan.steps(), 2);
+
+    array xa = {
+            {1, -2, 3},
+            {-4, 5, 6}
+    };
+
+    array wa = {
+            {1, 1, 1},
+            {1, 1, 1}
+    };
+
+    auto out = plan.run({xa, wa});
+
+    array expected = {
+            {0.5, 1, 2.5},
+            {2, 4.5, 5.5}
+    };
+
+    EXPECT_TRUE(nd::allclose(out[0], expected));
+    EXPECT_TRUE(nd::allclose(out[1], array(16.0)));
+
+    // the whole chain feeding the reduction is a single pass
+    EXPECT_EQ(g.compile({y.sum()}).steps(), 1);
+}
+
+TEST(graph, reduction_of_transposed_input) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto plan = g.compile({(exp(x) * 0.0 + x).max(), x + 1.0});
+
+    array xa = {
+            {1, 2, 3},
+            {4, 5, 6}
+    };
+
+    auto t = xa.transpose();
+    auto out = plan.run({t});
+
+    array expected = {
+            {2, 5},
+            {3, 6},
+            {4, 7}
+    };
+
+    EXPECT_EQ(out[0], array(6.0));
+    EXPECT_EQ(out[1], expected);
+}
+
+TEST(graph, buffer_reuse) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto w = g.input();
+    auto h = x;
+
+    for (int i = 0; i < 6; ++i) {
+        h = dot(h, w);
+    }
+
+    auto plan = g.compile({h});
+
+    EXPECT_EQ(plan.steps(), 6);
+    EXPECT_EQ(plan.buffers(), 2);
+
+    array xa({4, 4}, 1.0);
+    array eye({4, 4}, 0.0);
+    for (unsigned long i = 0; i < 4; ++i) eye.item({i, i}) = 2;
+
+    EXPECT_EQ(plan.run({xa, eye})[0], array({4, 4}, 64.0));
+}
+
+TEST(graph, plan_cache) {
+    nd::lazy::plan_cache<double> cache;
+    std::shared_ptr<const nd::lazy::compiled_graph<double>> first;
+
+    for (int request = 0; request < 3; ++request) {
+        nd::lazy::graph<double> g;
+
+        auto x = g.input();
+        auto y = sqrt(abs(x)) + 1.0;
+
+        auto plan = cache.compile(g, {y});
+
+        if (request == 0) first = plan;
+        EXPECT_EQ(plan, first);
+
+        array xa = {4, -9, 16};
+        EXPECT_EQ(plan->run({xa})[0], array({3, 4, 5}));
+    }
+
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(graph, plan_cache_inputs) {
+    nd::lazy::plan_cache<double> cache;
+
+    nd::lazy::graph<double> one;
+    auto x = one.input();
+    auto first = cache.compile(one, {x + 1.0});
+
+    nd::lazy::graph<double> two;
+    auto y = two.input();
+    two.input();
+    auto second = cache.compile(two, {y + 1.0});
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(cache.size(), 2);
+
+    array xa = {1, 2};
+    EXPECT_EQ(second->run({xa, xa})[0], array({2, 3}));
+}
+
+TEST(graph, reduction_order) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto plan = g.compile({x.sum()});
+
+    array xa(std::deque<unsigned long>({1000003}), 0.0);
+    xa.random(-1, 1);
+
+    // partials are folded per fused block of 256 elements in block order
+    double expected = 0;
+
+    for (unsigned long first = 0; first < xa.size(); first += 256) {
+        double partial = 0;
+
+        for (unsigned long i = first; i < std::min(xa.size(), first + 256); ++i) {
+            partial += xa.data()[i];
+        }
+
+        expected += partial;
+    }
+
+    for (int repeat = 0; repeat < 20; ++repeat) {
+        EXPECT_EQ(plan.run({xa})[0].data()[0], expected);
+    }
+}
+
+TEST(graph, dot_shapes) {
+    nd::lazy::graph<double> g;
+
+    auto a = g.input();
+    auto b = g.input();
+    auto v = g.input();
+    auto plan = g.compile({dot(a, b), dot(v, v)});
+
+    array x = {{1, 2, 3}, {4, 5, 6}};
+    array y = {{1, 0}, {0, 1}, {1, 1}};
+    array z = {1, 2, 3};
+
+    auto out = plan.run({x, y, z});
+    EXPECT_EQ(out[0], x.dot(y));
+    EXPECT_EQ(out[1], array(14.0));
+
+    EXPECT_THROW(plan.run({x, x, z}), std::runtime_error);
+}
+
+TEST(graph, infinite_max) {
+    nd::lazy::graph<double> g;
+
+    auto x = g.input();
+    auto plan = g.compile({x.max()});
+
+    auto inf = std::numeric_limits<double>::infinity();
+    auto xa = nd::full<double>({1000}, -inf);
+    EXPECT_EQ(plan.run({xa})[0], array(-inf));
+}
+
+TEST(graph, foreign_operands) {
+    nd::lazy::graph<double> g, h;
+
+    auto x = g.input();
+    auto y = h.input();
+
+    EXPECT_THROW(x + y, std::invalid_argument);
+    EXPECT_THROW(maximum(x, y), std::invalid_argument);
+    EXPECT_THROW(dot(x, y), std::invalid_argument);
+}
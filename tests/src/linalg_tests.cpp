@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+
+#include "linalg.hpp"
+
+using array = nd::array<double>;
+
+namespace {
+    // well conditioned n x n matrix with a dominant diagonal
+    array dominant(unsigned long n) {
+        array a({n, n}, 0.0);
+        a.random(-1, 1);
+
+        for (unsigned long i = 0; i < n; ++i) {
+            a.item({i, i}) += n;
+        }
+
+        return a;
+    }
+}
+
+TEST(linalg, solve) {
+    array a = {
+            {3, 1},
+            {1, 2}
+    };
+
+    array b = {9, 8};
+    array x = {2, 3};
+
+    EXPECT_TRUE(nd::allclose(nd::linalg::solve(a, b), x));
+
+    array singular = {
+            {1, 2},
+            {2, 4}
+    };
+
+    EXPECT_THROW(nd::linalg::solve(singular, b), std::runtime_error);
+}
+
+TEST(linalg, solve_blocked) {
+    auto a = dominant(150);
+
+    array b({150, 3}, 1.0);
+    auto x = nd::linalg::solve(a, b);
+
+    EXPECT_TRUE(nd::allclose(a.dot(x), b, 1e-9, 1e-9));
+}
+
+TEST(linalg, inv_det) {
+    array a = {
+            {4, 7},
+            {2, 6}
+    };
+
+    array inverse = {
+            {0.6, -0.7},
+            {-0.2, 0.4}
+    };
+
+    EXPECT_TRUE(nd::allclose(nd::linalg::inv(a), inverse));
+    EXPECT_TRUE(nd::allclose(nd::linalg::det(a), array(10.0)));
+
+    array swapped = {
+            {0, 1},
+            {1, 0}
+    };
+
+    EXPECT_TRUE(nd::allclose(nd::linalg::det(swapped), array(-1.0)));
+
+    auto big = dominant(100);
+    array eye({100, 100}, 0.0);
+    for (unsigned long i = 0; i < 100; ++i) eye.item({i, i}) = 1;
+
+    EXPECT_TRUE(nd::allclose(big.dot(nd::linalg::inv(big)), eye, 1e-9, 1e-9));
+}
+
+TEST(linalg, lu_factor_in_place) {
+    array a = {
+            {1, 2},
+            {3, 4}
+    };
+
+    auto piv = nd::linalg::lu_factor(a);
+
+    array lu = {
+            {3, 4},
+            {1.0 / 3, 2.0 / 3}
+    };
+
+    EXPECT_EQ(piv, nd::array<unsigned long>({1, 1}));
+    EXPECT_TRUE(nd::allclose(a, lu));
+}
+
+TEST(linalg, cholesky) {
+    auto m = dominant(130);
+    auto a = m.dot(m.transpose());
+
+    auto l = nd::linalg::cholesky(a);
+
+    EXPECT_TRUE(nd::allclose(l.dot(l.transpose()), a, 1e-9, 1e-9));
+    EXPECT_EQ(l.item({0, 1}), 0);
+
+    array indefinite = {
+            {1, 2},
+            {2, 1}
+    };
+
+    EXPECT_THROW(nd::linalg::cho_factor(indefinite), std::runtime_error);
+}
+
+TEST(linalg, qr) {
+    array a({160, 90}, 0.0);
+    a.random(-1, 1);
+
+    auto qr = nd::linalg::qr(a);
+
+    EXPECT_EQ(qr.first.shape(), std::deque<unsigned long>({160, 90}));
+    EXPECT_EQ(qr.second.shape(), std::deque<unsigned long>({90, 90}));
+    EXPECT_TRUE(nd::allclose(qr.first.dot(qr.second), a, 1e-9, 1e-9));
+
+    array eye({90, 90}, 0.0);
+    for (unsigned long i = 0; i < 90; ++i) eye.item({i, i}) = 1;
+
+    EXPECT_TRUE(nd::allclose(qr.first.transpose().dot(qr.first), eye, 1e-9, 1e-9));
+    EXPECT_EQ(qr.second.item({5, 4}), 0);
+}
+
+TEST(linalg, lstsq) {
+    // y = 1 + 2x fitted through exact points
+    array a = {
+            {1, 0},
+            {1, 1},
+            {1, 2},
+            {1, 3}
+    };
+
+    array b = {1, 3, 5, 7};
+    array x = {1, 2};
+
+    EXPECT_TRUE(nd::allclose(nd::linalg::lstsq(a, b), x));
+}
+
+TEST(linalg, batched) {
+    array a = {
+            {{2, 0}, {0, 4}},
+            {{1, 2}, {3, 4}},
+            {{4, 7}, {2, 6}}
+    };
+
+    array b = {
+            {2, 4},
+            {5, 11},
+            {11, 8}
+    };
+
+    auto x = nd::linalg::solve(a, b);
+
+    array expected = {
+            {1, 1},
+            {1, 2},
+            {1, 1}
+    };
+
+    EXPECT_TRUE(nd::allclose(x, expected));
+    EXPECT_TRUE(nd::allclose(nd::linalg::det(a), array({8, -2, 10})));
+    EXPECT_THROW(nd::linalg::solve(a, array({1, 2})), std::invalid_argument);
+}
@@ -55,3 +55,48 @@ TEST(matrix_op, dot) {
     }
 }
 
+
+TEST(matrix_op, dot_strided) {
+    nd::array<int> a = {
+            {1, 4},
+            {2, 5},
+            {3, 6}
+    };
+
+    nd::array<int> b = {
+            {7, 8},
+            {9, 10},
+            {11, 12}
+    };
+
+    nd::array<int> c = {
+            {58, 64},
+            {139, 154}
+    };
+
+    EXPECT_EQ(a.transpose().dot(b), c);
+
+    array large({130, 300}, 1.0);
+    array ones({300, 70}, 1.0);
+
+    EXPECT_EQ(large.dot(ones), array({130, 70}, 300.0));
+    EXPECT_THROW(large.dot(large), std::runtime_error);
+
+    // fewer rows than one block, the columns are split in strips instead
+    array wide({3, 1500}, 2.0);
+    array tall({1500, 1100}, 0.5);
+
+    EXPECT_EQ(wide.dot(tall), array({3, 1100}, 1500.0));
+}
+
+TEST(matrix_op, gemm_beta) {
+    // k spans three kc panels, c is scaled once in the first one only
+    std::vector<double> a(4 * 600, 1.0), b(600 * 5, 2.0), c(4 * 5, 3.0);
+
+    nd::kernel::gemm(4, 5, 600, 0.5, a.data(), 600, 1, b.data(), 5, 1, 2.0, c.data(), 5, 1);
+    EXPECT_EQ(c, std::vector<double>(20, 606.0));
+
+    // alpha of zero only scales c
+    nd::kernel::gemm(4, 5, 600, 0.0, a.data(), 600, 1, b.data(), 5, 1, 0.5, c.data(), 5, 1);
+    EXPECT_EQ(c, std::vector<double>(20, 303.0));
+}
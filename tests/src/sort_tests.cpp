@@ -0,0 +1,170 @@
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+using array = nd::array<double>;
+
+TEST(sorting, sort) {
+    array a = {3, 1, NAN, 2, -1};
+
+    a.sort();
+
+    EXPECT_EQ(a[0], array(-1));
+    EXPECT_EQ(a[3], array(3));
+    EXPECT_TRUE(std::isnan(a.data().at(4)));
+
+    array b = {
+            {3, 1, 2},
+            {0, 9, 4}
+    };
+
+    array rows = {
+            {1, 2, 3},
+            {0, 4, 9}
+    };
+
+    array columns = {
+            {0, 1, 2},
+            {3, 9, 4}
+    };
+
+    auto c = b;
+    c.sort();
+    EXPECT_EQ(c, rows);
+
+    c = b;
+    c.sort(0);
+    EXPECT_EQ(c, columns);
+
+    EXPECT_THROW(b.sort(2), std::invalid_argument);
+}
+
+TEST(sorting, sort_long_lines) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> uni(-100000, 100000);
+
+    for (unsigned long n : {7ul, 16ul, 100ul, 257ul, 5000ul}) {
+        nd::array<int> a({3, n}, 0);
+        a.unary_expr([&](double) { return uni(rng); });
+
+        std::uniform_real_distribution<double> real(-1e6, 1e6);
+        nd::array<double> b({3, n}, 0.);
+        b.unary_expr([&](double) { return real(rng); });
+
+        auto ints = a.data();
+        auto floats = b.data();
+
+        a.sort();
+        b.sort();
+
+        // every line must hold the same values as std::sort gives, so a pass that
+        // loses or duplicates a value is caught
+        for (unsigned long r = 0; r < 3; ++r) {
+            std::sort(ints.begin() + r * n, ints.begin() + (r + 1) * n);
+            std::sort(floats.begin() + r * n, floats.begin() + (r + 1) * n);
+        }
+
+        EXPECT_EQ(a.data(), ints) << "n = " << n;
+        EXPECT_EQ(b.data(), floats) << "n = " << n;
+    }
+
+    // keys differing only in the low byte take an odd number of radix passes
+    std::uniform_int_distribution<int> small(0, 200);
+    nd::array<int> d(std::deque<unsigned long>({1000}), 0);
+    d.unary_expr([&](double) { return small(rng); });
+
+    auto bytes = d.data();
+    d.sort();
+    std::sort(bytes.begin(), bytes.end());
+    EXPECT_EQ(d.data(), bytes);
+
+    // columns are gathered and sorted as lines too
+    nd::array<long> c({300, 2}, 0l);
+    c.unary_expr([&](double) { return uni(rng) * 100000l; });
+
+    auto column = c.transpose().flatten().data();
+    c.sort(0);
+    std::sort(column.begin(), column.begin() + 300);
+
+    for (unsigned long i = 0; i < 300; ++i) {
+        EXPECT_EQ(c.item({i, 0}), column[i]);
+    }
+}
+
+TEST(sorting, argsort) {
+    nd::array<int> a = {
+            {3, 1, 2},
+            {0, 9, 0}
+    };
+
+    nd::array<unsigned long> rows = {
+            {1, 2, 0},
+            {0, 2, 1}
+    };
+
+    nd::array<unsigned long> columns = {
+            {1, 0, 1},
+            {0, 1, 0}
+    };
+
+    EXPECT_EQ(a.argsort(), rows);
+    EXPECT_EQ(a.argsort(0), columns);
+}
+
+TEST(sorting, partition) {
+    array a = {9, 4, 7, 1, 3, 8, 2};
+
+    auto index = a.argpartition(3);
+    EXPECT_EQ(a.data().at(index.data().at(3)), 4);
+
+    a.partition(3);
+    EXPECT_EQ(a.data().at(3), 4);
+
+    for (unsigned long i = 0; i < 3; ++i) EXPECT_LT(a.data().at(i), 4);
+    for (unsigned long i = 4; i < 7; ++i) EXPECT_GT(a.data().at(i), 4);
+
+    EXPECT_THROW(a.partition(7), std::invalid_argument);
+}
+
+TEST(sorting, topk) {
+    array a = {
+            {5, 1, 9, 3},
+            {2, 8, 8, 0}
+    };
+
+    auto largest = a.topk(2);
+
+    array values = {
+            {9, 5},
+            {8, 8}
+    };
+
+    nd::array<unsigned long> indexes = {
+            {2, 0},
+            {1, 2}
+    };
+
+    EXPECT_EQ(largest.first, values);
+    EXPECT_EQ(largest.second, indexes);
+
+    auto smallest = a.topk(1, 0, false);
+
+    array column_values = {{2, 1, 8, 0}};
+    EXPECT_EQ(smallest.first, column_values);
+}
+
+TEST(sorting, topk_long_line) {
+    array a(std::deque<unsigned long>({1000000}), 0.0);
+    a.arrange(0, 1000000);
+
+    auto best = a.topk(100);
+
+    EXPECT_EQ(best.first.shape(), std::deque<unsigned long>({100}));
+
+    for (unsigned long i = 0; i < 100; ++i) {
+        EXPECT_EQ(best.first.data().at(i), 999999 - i);
+        EXPECT_EQ(best.second.data().at(i), 999999 - i);
+    }
+}
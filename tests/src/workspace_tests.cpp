@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+
+#include "array.hpp"
+
+using array = nd::array<double>;
+
+TEST(workspace, borrow) {
+    nd::workspace ws;
+
+    auto a = ws.borrow<double>(0, 16);
+    EXPECT_EQ(ws.capacity(), 16 * sizeof(double));
+
+    // smaller requests reuse the slot
+    EXPECT_EQ(ws.borrow<double>(0, 8), a);
+    EXPECT_EQ(ws.capacity(), 16 * sizeof(double));
+
+    ws.borrow<int>(3, 4);
+    EXPECT_EQ(ws.capacity(), 16 * sizeof(double) + 4 * sizeof(int));
+
+    // slots above the limit are freed, the rest are kept
+    ws.trim(4 * sizeof(int));
+    EXPECT_EQ(ws.capacity(), 4 * sizeof(int));
+
+    ws.release();
+    EXPECT_EQ(ws.capacity(), 0);
+}
+
+TEST(workspace, dot) {
+    array a = {{1, 2, 3}, {4, 5, 6}};
+    array b = {{1, 0}, {0, 1}, {1, 1}};
+    array out = nd::zeros<double>({2, 2});
+
+    nd::workspace ws;
+    auto data = out.data().data();
+
+    a.dot(b, out, ws);
+    auto capacity = ws.capacity();
+
+    for (int i = 0; i < 10; ++i) {
+        a.dot(b, out, ws);
+    }
+
+    EXPECT_EQ(out, a.dot(b));
+    EXPECT_EQ(out.data().data(), data);
+    EXPECT_EQ(ws.capacity(), capacity);
+
+    array scalar(0.);
+    array x = {1, 2, 3};
+    EXPECT_EQ(x.dot(x, scalar), array(14.));
+
+    EXPECT_THROW(a.dot(b, scalar), std::invalid_argument);
+    EXPECT_THROW(a.dot(a, out), std::runtime_error);
+
+    array stack = nd::zeros<double>({3, 2, 2});
+    auto view = stack.at(1);
+    EXPECT_THROW(a.dot(b, view), std::invalid_argument);
+}
+
+TEST(workspace, reductions) {
+    array a = {{1, 2, 3}, {4, 5, 6}};
+    array rows = nd::zeros<double>({2});
+    array columns = nd::zeros<double>({3});
+
+    EXPECT_EQ(a.sum(1, rows), array({6, 15}));
+    EXPECT_EQ(a.sum(0, columns), array({5, 7, 9}));
+    EXPECT_EQ(a.max(0, columns), array({4, 5, 6}));
+    EXPECT_EQ(a.min(1, rows), array({1, 4}));
+    EXPECT_EQ(a.mean(1, rows), array({2, 5}));
+
+    EXPECT_THROW(a.sum(0, rows), std::invalid_argument);
+
+    array table = nd::zeros<double>({2, 3});
+    auto view = table.at(0);
+    EXPECT_THROW(a.sum(0, view), std::invalid_argument);
+}
+
+TEST(workspace, elementwise) {
+    array a = {1, 2, 3};
+    array b = {4, 5, 6};
+    array out = nd::zeros_like(a);
+
+    EXPECT_EQ(nd::add(a, b, out), array({5, 7, 9}));
+    EXPECT_EQ(nd::multiply(out, 2., out), array({10, 14, 18}));
+    EXPECT_EQ(nd::subtract(out, a, out), array({9, 12, 15}));
+    EXPECT_EQ(nd::divide(out, 3., out), array({3, 4, 5}));
+
+    EXPECT_THROW(nd::add(a, array({1, 2}), out), std::invalid_argument);
+
+    // a view holds a copy of its base, writing to it would be lost
+    array table = nd::zeros<double>({2, 3});
+    auto view = table.at(1);
+    EXPECT_THROW(nd::add(a, b, view), std::invalid_argument);
+    EXPECT_THROW(nd::multiply(a, 2., view), std::invalid_argument);
+}